@@ -0,0 +1,74 @@
+#include "generator.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>  // int64_t
+#include <memory>  // allocator_arg
+#include <memory_resource>  // polymorphic_allocator, unsynchronized_pool_resource
+
+
+// Per-token cost of the two ways of tokenizing a text sentence by sentence
+// An outer coroutine walks the sentences, and an inner coroutine yields the tokens of a sentence
+namespace {
+    constexpr int sentences{ 1024 };
+
+    std::generator<int> sentence_tokens(int tokens) {
+        for (int i{ 0 }; i < tokens; ++i) {
+            co_yield i;
+        }
+    }
+
+    BEGIN_ALLOCATOR_ARG_COROUTINE
+    std::generator<int> sentence_tokens(std::allocator_arg_t, std::pmr::polymorphic_allocator<>, int tokens) {
+        for (int i{ 0 }; i < tokens; ++i) {
+            co_yield i;
+        }
+    }
+    END_ALLOCATOR_ARG_COROUTINE
+
+    // Every sentence allocates a new frame from the heap, and every token is yielded again by the outer coroutine
+    std::generator<int> reyielded_tokens(int tokens) {
+        for (int s{ 0 }; s < sentences; ++s) {
+            for (auto&& token : sentence_tokens(tokens)) {
+                co_yield token;
+            }
+        }
+    }
+
+    // Sentence frames are taken from a pool, and tokens are yielded straight from the inner coroutine
+    std::generator<int> pooled_nested_tokens(std::pmr::memory_resource* frame_pool, int tokens) {
+        for (int s{ 0 }; s < sentences; ++s) {
+            co_yield std::ranges::elements_of(sentence_tokens(std::allocator_arg, frame_pool, tokens));
+        }
+    }
+
+    // Argument: tokens per sentence
+    void generator_reyield(benchmark::State& state) {
+        auto tokens{ static_cast<int>(state.range(0)) };
+        for (auto _ : state) {
+            int64_t sum{};
+            for (auto&& token : reyielded_tokens(tokens)) {
+                sum += token;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * sentences * tokens);
+    }
+
+    void generator_pooled_elements_of(benchmark::State& state) {
+        auto tokens{ static_cast<int>(state.range(0)) };
+        std::pmr::unsynchronized_pool_resource frame_pool{};
+        for (auto _ : state) {
+            int64_t sum{};
+            for (auto&& token : pooled_nested_tokens(&frame_pool, tokens)) {
+                sum += token;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * sentences * tokens);
+    }
+}  // namespace
+
+
+// From one token per sentence, as for sentences without number words, to number-heavy sentences
+BENCHMARK(generator_reyield)->ArgName("tokens")->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK(generator_pooled_elements_of)->ArgName("tokens")->Arg(1)->Arg(8)->Arg(64);
@@ -0,0 +1,6 @@
+#include <benchmark/benchmark.h>
+
+
+// Results can be saved in JSON format with:
+//   word_converter_bench --benchmark_out=<FILE> --benchmark_out_format=json
+BENCHMARK_MAIN();
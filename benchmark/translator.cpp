@@ -0,0 +1,35 @@
+#include "corpus_generator.h"
+#include "input_reader.h"
+#include "translator.h"
+
+#include <algorithm>  // count
+#include <benchmark/benchmark.h>
+#include <cstdint>  // int64_t
+#include <memory>  // make_unique
+#include <string>
+
+
+namespace {
+    // Arguments: corpus size in KiB, and percentage of number expressions
+    void translator_translate(benchmark::State& state) {
+        std::string text{};
+        std::string expected_output{};
+        corpus_generator{ { .number_percent = static_cast<int>(state.range(1)) } }.generate(
+            static_cast<size_t>(state.range(0)) * 1024, text, expected_output);
+        auto sentences{ std::ranges::count(text, '.') };
+        for (auto _ : state) {
+            auto output{ translator{ std::make_unique<memory_reader>(text) }.translate() };
+            benchmark::DoNotOptimize(output);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+        state.counters["sentences"] = benchmark::Counter(static_cast<double>(sentences),
+            benchmark::Counter::kIsIterationInvariantRate);
+    }
+}  // namespace
+
+
+// From pure prose to number-heavy ledgers
+BENCHMARK(translator_translate)
+    ->ArgNames({ "KiB", "numbers%" })
+    ->ArgsProduct({ { 64, 1024, 16 * 1024 }, { 0, 10, 50, 100 } })
+    ->Unit(benchmark::kMillisecond);
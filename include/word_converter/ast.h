@@ -1,10 +1,15 @@
 #pragma once
 
 #include <algorithm>  // for_each
+#include <array>
+#include <charconv>  // to_chars
+#include <cstdint>  // int64_t
+#include <expected>
 #include <fmt/format.h>
-#include <numeric>  // accumulate
+#include <memory_resource>  // polymorphic_allocator
 #include <stdexcept>  // runtime_error
 #include <string>  // to_string
+#include <string_view>
 #include <unordered_map>
 #include <variant>  // visit
 #include <vector>
@@ -56,46 +61,100 @@ private:
 };
 
 
+// Computes the value of a number expression as its numbers are pushed
+// The value is kept up to date with every push, so it is ready as soon as the expression ends
+// Expressions have at most 19 number words (the longest path through the number expression machine),
+// and every number word adds at most one element to the stack, so the stack lives inline, with a fixed capacity
+// A malformed expression, e.g. 'one hundred hundred', is either reported by try_push, as a value, or thrown by push
 class number_expression_stack {
-    std::vector<int> numbers_{};
 public:
-    void push(int number) {
-        if (numbers_.empty()) {
-            numbers_.push_back(number);
-        } else if (number > numbers_.back()) {
-            int sum{};
-            while ((not numbers_.empty()) and (sum + numbers_.back() < number)) {
-                sum += numbers_.back();
-                numbers_.pop_back();
+    static constexpr size_t capacity{ 24 };
+private:
+    std::array<int64_t, capacity> numbers_{};
+    size_t size_{ 0 };
+    int64_t value_{ 0 };  // sum of all the elements in the stack
+private:
+    [[nodiscard]] std::expected<void, std::string> push_back(int64_t number) {
+        if (size_ == capacity) {
+            return std::unexpected{ fmt::format("more than {} numbers", capacity) };
+        }
+        numbers_[size_++] = number;
+        value_ += number;
+        return {};
+    }
+    [[nodiscard]] int64_t back() const {
+        return numbers_[size_ - 1];
+    }
+public:
+    // Returns the number expression found to be invalid, as shown in an invalid number expression error
+    [[nodiscard]] std::expected<void, std::string> try_push(int64_t number) {
+        if (size_ == 0 or number < back()) {
+            return push_back(number);
+        } else if (number > back()) {
+            int64_t sum{};
+            while ((size_ != 0) and (sum + back() < number)) {
+                sum += back();
+                --size_;
             }
-            numbers_.push_back(number * sum);
-        } else if (number < numbers_.back()) {
-            numbers_.push_back(number);
-        } else if (number == numbers_.back()) {
-            throw invalid_number_expression_error{
-                fmt::format("{} {}", number, numbers_.back())
-            };
+            value_ -= sum;
+            return push_back(number * sum);
         }
+        return std::unexpected{ fmt::format("{} {}", number, back()) };
     }
-    [[nodiscard]] int value() const {
-        return std::accumulate(numbers_.begin(), numbers_.end(), 0);
+    void push(int64_t number) {
+        if (auto result{ try_push(number) }; not result) {
+            throw invalid_number_expression_error{ result.error() };
+        }
+    }
+    void clear() {
+        size_ = 0;
+        value_ = 0;
+    }
+    [[nodiscard]] int64_t value() const {
+        return value_;
     }
 };
 
 
+// Nodes can be given an allocator, e.g. to draw their memory from an arena
+// Sentence and number expression nodes pass their allocator down to the nodes they hold
 namespace ast {
 
+using allocator_type = std::pmr::polymorphic_allocator<>;
+
+
+// Text sinks are anything text can be appended to, e.g. a std::string, or an output_writer
+template <typename Sink>
+concept text_sink = requires(Sink& sink, std::string_view text) {
+    sink.append(text);
+};
+
+
+// Appends the decimal representation of a number to a sink, without creating a temporary string
+void append_number(text_sink auto& sink, int64_t number) {
+    char buffer[24]{};
+    auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    sink.append(std::string_view{ buffer, static_cast<size_t>(ptr - buffer) });
+}
+
+
+// Every node offers dump() and evaluate(), which return a string,
+// and dump_into(sink) and evaluate_into(sink), which append to a sink
 struct text_node {
-    std::string data{};
-    explicit text_node(std::string text) : data{ std::move(text) } {}
-    [[nodiscard]] std::string dump() const { return data; }
-    [[nodiscard]] std::string evaluate() const { return data; }
+    std::pmr::string data{};
+    explicit text_node(std::string_view text, allocator_type allocator = {}) : data{ text, allocator } {}
+    void dump_into(text_sink auto& sink) const { sink.append(data); }
+    void evaluate_into(text_sink auto& sink) const { sink.append(data); }
+    [[nodiscard]] std::string dump() const { return std::string{ data }; }
+    [[nodiscard]] std::string evaluate() const { return std::string{ data }; }
 };
 
 
 struct int_node {
     int data{};
     explicit int_node(int value) : data{ value } {}
+    void dump_into(text_sink auto& sink) const { sink.append(number_to_word_map.at(data)); }
+    void evaluate_into(text_sink auto& sink) const { append_number(sink, data); }
     [[nodiscard]] std::string dump() const { return number_to_word_map.at(data); }
     [[nodiscard]] std::string evaluate() const { return std::to_string(data); }
 };
@@ -103,38 +162,46 @@ struct int_node {
 
 class number_expression_node {
     using node_t = std::variant<text_node, int_node>;
-    using nodes_t = std::vector<node_t>;
+    using nodes_t = std::pmr::vector<node_t>;
 private:
     nodes_t nodes_{};
+    number_expression_stack numbers_{};  // updated as int nodes are added
 public:
+    number_expression_node() = default;
+    explicit number_expression_node(allocator_type allocator) : nodes_{ allocator } {}
+
+    [[nodiscard]] allocator_type get_allocator() const { return nodes_.get_allocator(); }
     void add(node_t n) {
+        if (std::holds_alternative<int_node>(n)) {
+            numbers_.push(std::get<int_node>(n).data);
+        }
         nodes_.push_back(std::move(n));
     }
-    [[nodiscard]] int value() const {
-        number_expression_stack numbers_stack{};
-        std::ranges::for_each(nodes_, [&numbers_stack](const auto& node) {
-            if (std::holds_alternative<int_node>(node)) {
-                numbers_stack.push(std::get<int_node>(node).data);
-            }
-        });
-        return numbers_stack.value();
+    [[nodiscard]] int64_t value() const {
+        return numbers_.value();
     }
-    [[nodiscard]] std::string dump() const {
-        std::string ret{};
-        std::ranges::for_each(nodes_, [&ret](auto&& node) {
-            std::visit([&ret](auto&& arg) { ret += arg.dump(); }, node);
+    void dump_into(text_sink auto& sink) const {
+        std::ranges::for_each(nodes_, [&sink](auto&& node) {
+            std::visit([&sink](auto&& arg) { arg.dump_into(sink); }, node);
         });
-        return ret;
     }
-    [[nodiscard]] std::string evaluate() const {
+    void evaluate_into(text_sink auto& sink) const {
         if (nodes_.empty()) {
-            return {};
+            return;
         }
-        auto expression_value{ value() };
-        std::string ret{ std::to_string(expression_value) };
+        append_number(sink, value());
         if (std::holds_alternative<text_node>(nodes_.back())) {
-            ret += std::get<text_node>(nodes_.back()).data;
+            std::get<text_node>(nodes_.back()).evaluate_into(sink);
         }
+    }
+    [[nodiscard]] std::string dump() const {
+        std::string ret{};
+        dump_into(ret);
+        return ret;
+    }
+    [[nodiscard]] std::string evaluate() const {
+        std::string ret{};
+        evaluate_into(ret);
         return ret;
     }
 };
@@ -142,25 +209,35 @@ public:
 
 class sentence_node {
     using node_t = std::variant<text_node, number_expression_node>;
-    using nodes_t = std::vector<node_t>;
+    using nodes_t = std::pmr::vector<node_t>;
 private:
-     nodes_t nodes_{};
+    nodes_t nodes_{};
 public:
+    sentence_node() = default;
+    explicit sentence_node(allocator_type allocator) : nodes_{ allocator } {}
+
+    [[nodiscard]] allocator_type get_allocator() const { return nodes_.get_allocator(); }
     void add(node_t n) {
         nodes_.push_back(std::move(n));
     }
+    void dump_into(text_sink auto& sink) const {
+        std::ranges::for_each(nodes_, [&sink](auto&& node) {
+            std::visit([&sink](auto&& arg) { arg.dump_into(sink); }, node);
+        });
+    }
+    void evaluate_into(text_sink auto& sink) const {
+        std::ranges::for_each(nodes_, [&sink](auto&& node) {
+            std::visit([&sink](auto&& arg) { arg.evaluate_into(sink); }, node);
+        });
+    }
     [[nodiscard]] std::string dump() const {
         std::string ret{};
-        std::ranges::for_each(nodes_, [&ret](auto&& node) {
-            std::visit([&ret](auto&& arg) { ret += arg.dump(); }, node);
-        });
+        dump_into(ret);
         return ret;
     }
     [[nodiscard]] std::string evaluate() const {
         std::string ret{};
-        std::ranges::for_each(nodes_, [&ret](auto&& node) {
-            std::visit([&ret](auto&& arg) { ret += arg.evaluate(); }, node);
-        });
+        evaluate_into(ret);
         return ret;
     }
 };
@@ -175,15 +252,21 @@ public:
     void add(node_t n) {
         nodes_.push_back(std::move(n));
     }
+    void dump_into(text_sink auto& sink) const {
+        std::ranges::for_each(nodes_, [&sink](const auto& node) { node.dump_into(sink); });
+    }
+    void evaluate_into(text_sink auto& sink) const {
+        std::ranges::for_each(nodes_, [&sink](const auto& node) { node.evaluate_into(sink); });
+    }
     [[nodiscard]] std::string dump() const {
-        return std::accumulate(nodes_.begin(), nodes_.end(), std::string{}, [](const auto& total, const auto& node) {
-            return total + node.dump();
-        });
+        std::string ret{};
+        dump_into(ret);
+        return ret;
     }
     [[nodiscard]] std::string evaluate() const {
-        return std::accumulate(nodes_.begin(), nodes_.end(), std::string{}, [](const auto& total, const auto& node) {
-            return total + node.evaluate();
-        });
+        std::string ret{};
+        evaluate_into(ret);
+        return ret;
     }
 };
 
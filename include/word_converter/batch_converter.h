@@ -0,0 +1,260 @@
+#pragma once
+
+#include "input_reader.h"
+#include "output_writer.h"
+#include "translator.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>  // sort, stable_sort
+#include <cstdint>  // uintmax_t
+#include <exception>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <map>
+#include <memory>  // make_unique
+#include <set>
+#include <stdexcept>  // runtime_error
+#include <string>
+#include <system_error>  // error_code
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+struct could_not_read_directory_error : public std::runtime_error {
+    explicit could_not_read_directory_error(const fs::path& dir_path) : std::runtime_error{ "" } {
+        message_ += fmt::format("'{}'", dir_path.generic_string());
+    }
+    [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+private:
+    std::string message_{ "could not read directory: " };
+};
+
+
+struct output_file_is_an_input_file_error : public std::runtime_error {
+    explicit output_file_is_an_input_file_error(const fs::path& file_path) : std::runtime_error{ "" } {
+        message_ += fmt::format("'{}'", file_path.generic_string());
+    }
+    [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+private:
+    std::string message_{ "output file is an input file: " };
+};
+
+
+struct duplicate_output_file_error : public std::runtime_error {
+    explicit duplicate_output_file_error(const fs::path& file_path) : std::runtime_error{ "" } {
+        message_ += fmt::format("'{}'", file_path.generic_string());
+    }
+    [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+private:
+    std::string message_{ "output file is also the output of another input file: " };
+};
+
+
+struct batch_job {
+    fs::path input_file{};
+    fs::path output_file{};
+    std::string error{};  // if the job cannot be run, e.g. because its output file would overwrite an input file
+};
+
+
+struct batch_result {
+    fs::path input_file{};
+    fs::path output_file{};
+    std::string error{};
+    std::vector<sentence_error> sentence_errors{};  // only in recovery mode
+
+    [[nodiscard]] bool ok() const { return error.empty(); }
+};
+
+
+// Output path of an input file, mirrored under the output directory
+// Files found in an input directory keep their path relative to that directory
+// Other files keep their relative path, unless it goes outside the current directory, in which case only their name is kept
+[[nodiscard]] inline fs::path mirror_path(const fs::path& input_file, const fs::path& input_dir, const fs::path& output_dir) {
+    if (not input_dir.empty()) {
+        return output_dir / input_file.lexically_relative(input_dir);
+    }
+    auto relative_path{ input_file.lexically_normal() };
+    if (relative_path.is_absolute() or relative_path.empty() or *relative_path.begin() == "..") {
+        return output_dir / input_file.filename();
+    }
+    return output_dir / relative_path;
+}
+
+
+// Reads a list of input paths, one per line
+// Empty lines are skipped
+[[nodiscard]] inline std::vector<fs::path> read_list_file(const fs::path& list_file) {
+    std::error_code ec{};
+    if (not fs::is_regular_file(list_file, ec)) {
+        throw file_is_not_a_regular_file_error{ list_file };
+    }
+    std::vector<fs::path> ret{};
+    std::ifstream ifs{ list_file };
+    for (std::string line{}; std::getline(ifs, line);) {
+        if (not line.empty() and line.back() == '\r') {
+            line.pop_back();
+        }
+        if (not line.empty()) {
+            ret.emplace_back(line);
+        }
+    }
+    return ret;
+}
+
+
+namespace detail {
+    // Walks a directory recursively, without following symbolic links to directories
+    // A subdirectory that cannot be read becomes a job of its own, failed with a could not read directory error,
+    // and the walk goes on with the other ones
+    [[nodiscard]] inline std::vector<batch_job> find_input_files(const fs::path& input_dir) {
+        std::vector<batch_job> ret{};
+        std::vector<fs::path> dirs{ input_dir };
+        while (not dirs.empty()) {
+            auto dir{ std::move(dirs.back()) };
+            dirs.pop_back();
+            std::error_code ec{};
+            for (fs::directory_iterator it{ dir, ec }; not ec and it != fs::directory_iterator{}; it.increment(ec)) {
+                std::error_code entry_ec{};
+                if (it->is_directory(entry_ec) and not it->is_symlink(entry_ec)) {
+                    dirs.push_back(it->path());
+                } else if (it->is_regular_file(entry_ec)) {
+                    ret.push_back({ .input_file = it->path() });
+                }
+            }
+            if (ec) {
+                ret.push_back({ .input_file = dir, .error = could_not_read_directory_error{ dir }.what() });
+            }
+        }
+        std::ranges::sort(ret, {}, &batch_job::input_file);
+        return ret;
+    }
+
+    // Files are told apart by their absolute path, with symbolic links resolved, so that different paths to a file match
+    [[nodiscard]] inline fs::path get_file_key(const fs::path& file_path) {
+        std::error_code ec{};
+        auto ret{ fs::weakly_canonical(file_path, ec) };
+        return ec ? fs::absolute(file_path, ec).lexically_normal() : ret;
+    }
+}  // namespace detail
+
+
+// Builds the list of jobs for a set of input paths
+// Directories are walked recursively, and every regular file in them becomes a job
+// Any other input path becomes a job as it is, so that errors are reported for that file
+// A job whose output file would overwrite an input file, or the output file of an earlier job, is failed
+// before being run, since both files would then be written, or read and written, at the same time
+[[nodiscard]] inline std::vector<batch_job> collect_batch_jobs(const std::vector<fs::path>& input_paths, const fs::path& output_dir) {
+    std::vector<batch_job> ret{};
+    for (const auto& input_path : input_paths) {
+        std::error_code ec{};
+        if (fs::is_directory(input_path, ec)) {
+            for (auto& job : detail::find_input_files(input_path)) {
+                job.output_file = mirror_path(job.input_file, input_path, output_dir);
+                ret.push_back(std::move(job));
+            }
+        } else {
+            ret.push_back({ input_path, mirror_path(input_path, {}, output_dir) });
+        }
+    }
+
+    std::set<fs::path> input_keys{};
+    for (const auto& job : ret) {
+        input_keys.insert(detail::get_file_key(job.input_file));
+    }
+    std::set<fs::path> output_keys{};
+    for (auto& job : ret) {
+        if (not job.error.empty()) {
+            continue;
+        }
+        auto output_key{ detail::get_file_key(job.output_file) };
+        if (input_keys.contains(output_key)) {
+            job.error = output_file_is_an_input_file_error{ job.output_file }.what();
+        } else if (not output_keys.insert(output_key).second) {
+            job.error = duplicate_output_file_error{ job.output_file }.what();
+        }
+    }
+    return ret;
+}
+
+
+// Converts a batch of files on a work-stealing pool
+// Every file is converted by its own translator, and written out to its own output file
+// Errors are caught per file, so a failing file does not stop the others, and its partial output file is removed
+// In recovery mode, malformed sentences are copied through, and returned as part of the results of their file
+class batch_converter {
+    size_t jobs_{};
+    bool recover_{};
+private:
+    [[nodiscard]] std::string convert_file(const batch_job& job, std::vector<sentence_error>& sentence_errors) const {
+        if (not job.error.empty()) {
+            return job.error;
+        }
+        bool output_file_created{ false };
+        try {
+            auto input_reader{ std::make_unique<mapped_file_reader>(job.input_file) };
+            std::error_code ec{};
+            // E.g. a hard link to the input file, which collecting the jobs cannot tell
+            if (fs::equivalent(job.input_file, job.output_file, ec)) {
+                throw output_file_is_an_input_file_error{ job.output_file };
+            }
+            fs::create_directories(job.output_file.parent_path(), ec);  // the output writer reports the error, if any
+#ifdef _WIN32
+            file_writer output_writer{ job.output_file };
+#else
+            multi_sink_writer output_writer{};
+            output_writer.add_sink(job.output_file);
+#endif
+            output_file_created = true;
+            translator t{ std::move(input_reader) };
+            if (recover_) {
+                t.translate_into(output_writer, [&sentence_errors](const sentence_error& error) { sentence_errors.push_back(error); });
+            } else {
+                t.translate_into(output_writer);
+            }
+            output_writer.flush();
+        } catch (const std::exception& ex) {
+            if (output_file_created) {
+                std::error_code ec{};
+                fs::remove(job.output_file, ec);
+            }
+            return ex.what();
+        }
+        return {};
+    }
+
+    [[nodiscard]] static std::uintmax_t get_file_size(const fs::path& file_path) {
+        std::error_code ec{};
+        auto ret{ fs::file_size(file_path, ec) };
+        return ec ? 0 : ret;
+    }
+public:
+    explicit batch_converter(size_t jobs, bool recover = false) : jobs_{ jobs }, recover_{ recover } {}
+
+    // Results are returned in the same order as the jobs
+    [[nodiscard]] std::vector<batch_result> convert(const std::vector<batch_job>& jobs) {
+        std::vector<batch_result> ret(jobs.size());
+        // Biggest files are dealt first, so that they do not end up being the last ones to start
+        std::vector<size_t> order(jobs.size());
+        std::vector<std::uintmax_t> sizes(jobs.size());
+        for (size_t i{ 0 }; i < jobs.size(); ++i) {
+            order[i] = i;
+            sizes[i] = get_file_size(jobs[i].input_file);
+        }
+        std::ranges::stable_sort(order, [&sizes](size_t lhs, size_t rhs) { return sizes[lhs] > sizes[rhs]; });
+
+        std::vector<work_stealing_pool::task_t> tasks{};
+        tasks.reserve(jobs.size());
+        for (auto i : order) {
+            tasks.emplace_back([this, &jobs, &ret, i]() {
+                ret[i].input_file = jobs[i].input_file;
+                ret[i].output_file = jobs[i].output_file;
+                ret[i].error = convert_file(jobs[i], ret[i].sentence_errors);
+            });
+        }
+        work_stealing_pool{ jobs_ }.run(std::move(tasks));
+        return ret;
+    }
+};
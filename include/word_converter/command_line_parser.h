@@ -1,10 +1,16 @@
 # pragma once
 
+#include "output_writer.h"  // flush_policy
+
+#include <charconv>  // from_chars
 #include <cstring>
 #include <fmt/format.h>
 #include <optional>
 #include <stdexcept>  // runtime_error
 #include <string>  // to_string
+#include <string_view>
+#include <system_error>  // errc
+#include <vector>
 
 
 struct invalid_number_of_arguments_error : public std::runtime_error {
@@ -18,54 +24,173 @@ private:
 
 
 struct invalid_argument_error : public std::runtime_error {
-    explicit invalid_argument_error(const std::string& arg) : std::runtime_error{ "" } {
-        message_ += fmt::format("'{}'", arg);
-    }
+    explicit invalid_argument_error(const std::string& arg) : invalid_argument_error{ "invalid argument: ", arg } {}
     [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+protected:
+    invalid_argument_error(const std::string& message, const std::string& arg) : std::runtime_error{ "" } {
+        message_ = message + fmt::format("'{}'", arg);
+    }
 private:
-    std::string message_{ "invalid argument: " };
+    std::string message_{};
+};
+
+
+struct missing_argument_error : public invalid_argument_error {
+    explicit missing_argument_error(const std::string& arg) : invalid_argument_error{ "missing argument: ", arg } {}
 };
 
 
+// How input and output files are read and written
+// - mapped: input files are mapped into memory, and output is written with writev from a user-space buffer
+// - io_uring: several large reads and writes are kept in flight on an io_uring, or done with read and write if it is not available
+// - read: same blocks as io_uring, but read and written with read and write
+enum class io_mode { mapped, io_uring, read };
+
+
+// How the statistics of a conversion are printed out: as a table, or as a JSON object
+enum class stats_format { text, json };
+
+
 struct command_line_options {
-    std::string input_file{};
+    std::vector<std::string> input_files{};
+    std::optional<std::string> list_file{};
     std::optional<std::string> output_file{};
+    size_t jobs{ 1 };
+    std::optional<flush_policy> flush{};
+    std::optional<std::string> socket_file{};
+    std::optional<std::string> error_report_file{};
+    io_mode io{ io_mode::mapped };
+    std::optional<size_t> pipeline_block_size{};
+    std::optional<stats_format> stats{};
+    std::optional<std::string> trace_file{};
 };
 
 
 struct command_line_parser {
+private:
+    [[nodiscard]] static size_t parse_jobs(const std::string& value) {
+        size_t ret{};
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), ret);
+        if (ec != std::errc{} or ptr != value.data() + value.size() or ret == 0) {
+            throw invalid_argument_error{ value };
+        }
+        return ret;
+    }
+    [[nodiscard]] static size_t parse_number(std::string_view value) {
+        size_t ret{};
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), ret);
+        if (ec != std::errc{} or ptr != value.data() + value.size()) {
+            throw invalid_argument_error{ std::string{ value } };
+        }
+        return ret;
+    }
+    // sentence, a number of bytes, optionally with a K or M suffix, or a number of milliseconds, with an ms suffix
+    // Repeating -f with a number of bytes and a number of milliseconds flushes on whichever threshold comes first
+    static void parse_flush(const std::string& value, std::optional<flush_policy>& policy) {
+        std::string_view number{ value };
+        if (not policy) {
+            policy = flush_policy{};
+        }
+        if (value == "sentence") {
+            *policy = flush_policy{};
+        } else if (number.ends_with("ms")) {
+            number.remove_suffix(2);
+            policy->interval = std::chrono::milliseconds{ parse_number(number) };
+        } else {
+            policy->bytes = parse_size(number);
+        }
+    }
+    // A number of bytes, optionally with a K or M suffix
+    [[nodiscard]] static size_t parse_size(std::string_view value) {
+        size_t multiplier{ 1 };
+        if (value.ends_with('K')) {
+            multiplier = size_t{ 1 } << 10;
+        } else if (value.ends_with('M')) {
+            multiplier = size_t{ 1 } << 20;
+        }
+        if (multiplier != 1) {
+            value.remove_suffix(1);
+        }
+        return parse_number(value) * multiplier;
+    }
+    [[nodiscard]] static size_t parse_block_size(const std::string& value) {
+        auto ret{ parse_size(value) };
+        if (ret == 0) {
+            throw invalid_argument_error{ value };
+        }
+        return ret;
+    }
+    [[nodiscard]] static io_mode parse_io(const std::string& value) {
+        if (value == "mmap") {
+            return io_mode::mapped;
+        } else if (value == "uring") {
+            return io_mode::io_uring;
+        } else if (value == "read") {
+            return io_mode::read;
+        }
+        throw invalid_argument_error{ value };
+    }
+    [[nodiscard]] static stats_format parse_stats(const std::string& option) {
+        if (option == "--stats" or option == "--stats=text") {
+            return stats_format::text;
+        } else if (option == "--stats=json") {
+            return stats_format::json;
+        }
+        throw invalid_argument_error{ option };
+    }
+public:
+    // Options can come in any order
+    // Every option but --stats takes a value: -i <INPUT_PATH>, -l <LIST_FILE_PATH>, -o <OUTPUT_PATH>, -j <JOBS>, -f <FLUSH>
+    // --serve <SOCKET_PATH> runs a conversion server instead of converting files
+    // --recover <ERROR_REPORT_PATH> copies malformed sentences through, and reports them, instead of stopping at the first one
+    // --io <IO> tells how files are read and written: mmap (default), uring, or read
+    // --pipeline <BLOCK_SIZE> reads, converts, and writes on three threads, handing over blocks of that size
+    // --trace <TRACE_PATH> writes out a Chrome trace-event JSON timeline of the conversion
+    // --stats, or --stats=json, prints out the time spent in, and the work done by, every stage of a conversion
+    // -i can be repeated, and at least one -i, -l, or --serve is needed
+    // - is a valid value, and stands for the standard input or output
     [[nodiscard]] static auto parse(int argc, const char** argv) {
         command_line_options clo{};
-        if (argc != 3 and argc != 5) {
+        if (argc == 1) {
             throw invalid_number_of_arguments_error{ argc };
         }
-        std::string argv_1{ argv[1] };
-        std::string dash_i_arg{ "-i" };
-        std::string dash_o_arg{ "-o" };
-        if (argc == 3) {
-            if (argv_1 != dash_i_arg) {
-                throw invalid_argument_error{ argv_1 };
+        for (int i{ 1 }; i < argc; ++i) {
+            std::string option{ argv[i] };
+            if (option.starts_with("--stats")) {
+                clo.stats = parse_stats(option);
+                continue;
+            }
+            if (i + 1 == argc or (argv[i + 1][0] == '-' and argv[i + 1][1] != '\0')) {
+                throw invalid_number_of_arguments_error{ argc };
             }
-            clo.input_file = argv[2];
-        } else {  // argc == 5
-            std::string argv_3{ argv[3] };
-            if (argv_1 == dash_i_arg) {  // -i in -o out
-                if (argv_3 != dash_o_arg) {
-                    throw invalid_argument_error{ argv_3 };
-                }
-                clo.input_file = argv[2];
-                clo.output_file = argv[4];
-            } else {  // -o out -i in
-                if (argv_1 != dash_o_arg) {
-                    throw invalid_argument_error{ argv_1 };
-                }
-                if (argv_3 != dash_i_arg) {
-                    throw invalid_argument_error{ argv_3 };
-                }
-                clo.input_file = argv[4];
-                clo.output_file = argv[2];
+            std::string value{ argv[++i] };
+            if (option == "-i") {
+                clo.input_files.push_back(value);
+            } else if (option == "-l") {
+                clo.list_file = value;
+            } else if (option == "-o") {
+                clo.output_file = value;
+            } else if (option == "-j") {
+                clo.jobs = parse_jobs(value);
+            } else if (option == "-f") {
+                parse_flush(value, clo.flush);
+            } else if (option == "--serve") {
+                clo.socket_file = value;
+            } else if (option == "--recover") {
+                clo.error_report_file = value;
+            } else if (option == "--io") {
+                clo.io = parse_io(value);
+            } else if (option == "--pipeline") {
+                clo.pipeline_block_size = parse_block_size(value);
+            } else if (option == "--trace") {
+                clo.trace_file = value;
+            } else {
+                throw invalid_argument_error{ option };
             }
         }
+        if (clo.input_files.empty() and not clo.list_file and not clo.socket_file) {
+            throw missing_argument_error{ "-i" };
+        }
         return clo;
     }
 };
@@ -0,0 +1,330 @@
+#pragma once
+
+// Unix domain sockets are only supported on Unix-like systems
+#ifndef _WIN32
+
+#include "file_descriptor.h"
+#include "input_reader.h"  // memory_reader
+#include "translator.h"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>  // uint8_t, uint32_t
+#include <filesystem>
+#include <fmt/format.h>
+#include <list>
+#include <memory>  // make_unique
+#include <stdexcept>  // runtime_error
+#include <string>
+#include <string_view>
+#include <system_error>  // error_code, system_category
+#include <thread>  // jthread
+
+#include <poll.h>  // poll
+#include <sys/socket.h>  // accept, bind, connect, listen, recv, send, shutdown, socket
+#include <sys/un.h>  // sockaddr_un
+#include <unistd.h>  // pipe, write
+
+namespace fs = std::filesystem;
+
+
+struct socket_error : public std::runtime_error {
+    socket_error(const std::string& operation, int error) : std::runtime_error{ "" } {
+        message_ += fmt::format("'{}': {}", operation, std::system_category().message(error));
+    }
+    [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+private:
+    std::string message_{ "socket error: " };
+};
+
+
+struct conversion_request_error : public std::runtime_error {
+    explicit conversion_request_error(const std::string& error) : std::runtime_error{ "" } {
+        message_ += error;
+    }
+    [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+private:
+    std::string message_{ "conversion request failed: " };
+};
+
+
+// Wire format of the conversion requests and responses
+// A request is a length followed by the text to convert
+// A response is a status, a length, and the converted text or, if the status is not ok, an error message
+// Lengths are 4-byte unsigned integers in network byte order
+// A connection can carry any number of requests, each one answered before the next one is read
+namespace conversion_protocol {
+    enum class status_t : uint8_t { ok = 0, error = 1 };
+
+    using length_t = std::array<char, 4>;
+
+    // Bigger requests are answered with an error, and their connection is closed
+    inline constexpr size_t max_request_size{ size_t{ 64 } * 1024 * 1024 };
+
+    [[nodiscard]] constexpr length_t encode_length(uint32_t length) {
+        return {
+            static_cast<char>(length >> 24), static_cast<char>(length >> 16),
+            static_cast<char>(length >> 8), static_cast<char>(length)
+        };
+    }
+    [[nodiscard]] constexpr uint32_t decode_length(const length_t& bytes) {
+        uint32_t ret{ 0 };
+        for (auto byte : bytes) {
+            ret = (ret << 8) | static_cast<uint8_t>(byte);
+        }
+        return ret;
+    }
+}  // namespace conversion_protocol
+
+
+// Blocking socket I/O
+// Writes never raise SIGPIPE, so a client going away is reported as an error instead of killing the process
+namespace socket_io {
+#ifdef MSG_NOSIGNAL
+    inline constexpr int send_flags{ MSG_NOSIGNAL };
+#else
+    inline constexpr int send_flags{ 0 };
+#endif
+
+    // Returns false if the connection is closed before size bytes are read
+    [[nodiscard]] inline bool read_exactly(int fd, char* data, size_t size) {
+        while (size > 0) {
+            auto n{ ::recv(fd, data, size, 0) };
+            if (n == -1 and errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+    // Returns false if the connection is closed before all the bytes are written
+    [[nodiscard]] inline bool write_all(int fd, std::string_view data) {
+        while (not data.empty()) {
+            auto n{ ::send(fd, data.data(), data.size(), send_flags) };
+            if (n == -1 and errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            data.remove_prefix(static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    [[nodiscard]] inline sockaddr_un make_address(const fs::path& socket_path, const std::string& operation) {
+        sockaddr_un ret{};
+        ret.sun_family = AF_UNIX;
+        const auto& path{ socket_path.native() };
+        if (path.size() >= sizeof(ret.sun_path)) {
+            throw socket_error{ operation, ENAMETOOLONG };
+        }
+        path.copy(ret.sun_path, path.size());
+        return ret;
+    }
+}  // namespace socket_io
+
+
+// Keeps a process converting the requests sent to a Unix domain socket, so that clients do not pay for starting one
+// Every connection is served by its own thread and its own translator, which is reset for every request,
+// so its lexer, pool of coroutine frames, and output buffers are reused from one request to the next
+class conversion_server {
+    // A connection is closed once its thread has finished
+    struct connection {
+        file_descriptor socket{};
+        std::atomic<bool> done{ false };
+        std::jthread thread{};
+    };
+
+    fs::path socket_path_{};
+    file_descriptor listener_{};
+    // Self-pipe, written to by stop, and polled together with the listener
+    file_descriptor stop_reader_{};
+    file_descriptor stop_writer_{};
+    std::list<connection> connections_{};
+private:
+    [[nodiscard]] static bool respond(int fd, conversion_protocol::status_t status, std::string_view text) {
+        auto length{ conversion_protocol::encode_length(static_cast<uint32_t>(text.size())) };
+        std::array<char, 5> header{ static_cast<char>(status), length[0], length[1], length[2], length[3] };
+        return socket_io::write_all(fd, { header.data(), header.size() }) and socket_io::write_all(fd, text);
+    }
+
+    static void serve(int fd) {
+        using namespace conversion_protocol;
+        translator t{ std::make_unique<memory_reader>(std::string_view{}) };
+        std::string request{};
+        std::string response{};
+        for (length_t length{}; socket_io::read_exactly(fd, length.data(), length.size());) {
+            auto size{ decode_length(length) };
+            if (size > max_request_size) {
+                (void) respond(fd, status_t::error, fmt::format("request too large: {} bytes", size));
+                return;
+            }
+            request.resize(size);
+            if (not socket_io::read_exactly(fd, request.data(), request.size())) {
+                return;
+            }
+            response.clear();
+            auto status{ status_t::ok };
+            try {
+                t.reset(std::make_unique<memory_reader>(request));
+                t.translate_into(response);
+            } catch (const std::exception& ex) {
+                status = status_t::error;
+                response = ex.what();
+            }
+            if (not respond(fd, status, response)) {
+                return;
+            }
+        }
+    }
+
+    void accept_connection() {
+        file_descriptor socket{ ::accept(listener_.get(), nullptr, nullptr) };
+        if (socket.get() == -1) {  // e.g. the client went away before being accepted
+            return;
+        }
+        auto& c{ connections_.emplace_back() };
+        c.socket = std::move(socket);
+        c.thread = std::jthread{ [&c]() {
+            serve(c.socket.get());
+            c.done = true;
+        } };
+    }
+    void remove_finished_connections() {
+        connections_.remove_if([](const connection& c) { return c.done.load(); });
+    }
+    // A socket file nobody listens on, i.e. one refusing connections
+    [[nodiscard]] static bool is_stale_socket(const sockaddr_un& address) {
+        file_descriptor probe{ ::socket(AF_UNIX, SOCK_STREAM, 0) };
+        if (probe.get() == -1) {
+            throw socket_error{ "socket", errno };
+        }
+        if (::connect(probe.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+            return false;
+        }
+        return errno == ECONNREFUSED;
+    }
+public:
+    // A stale socket file, e.g. left over by a server that was killed, is replaced
+    // The socket of a server still running, or one that cannot be told to be stale, is left alone, and the address is in use
+    explicit conversion_server(fs::path socket_path) : socket_path_{ std::move(socket_path) } {
+        auto address{ socket_io::make_address(socket_path_, "bind") };
+        listener_ = file_descriptor{ ::socket(AF_UNIX, SOCK_STREAM, 0) };
+        if (listener_.get() == -1) {
+            throw socket_error{ "socket", errno };
+        }
+        std::error_code ec{};
+        if (fs::is_socket(socket_path_, ec)) {
+            if (not is_stale_socket(address)) {
+                throw socket_error{ "bind", EADDRINUSE };
+            }
+            fs::remove(socket_path_, ec);
+        }
+        if (::bind(listener_.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) {
+            throw socket_error{ "bind", errno };
+        }
+        if (::listen(listener_.get(), SOMAXCONN) == -1) {
+            auto error{ errno };
+            fs::remove(socket_path_, ec);
+            throw socket_error{ "listen", error };
+        }
+        std::array<int, 2> fds{};
+        if (::pipe(fds.data()) == -1) {
+            auto error{ errno };
+            fs::remove(socket_path_, ec);
+            throw socket_error{ "pipe", error };
+        }
+        stop_reader_ = file_descriptor{ fds[0] };
+        stop_writer_ = file_descriptor{ fds[1] };
+    }
+    conversion_server(const conversion_server&) = delete;
+    conversion_server& operator=(const conversion_server&) = delete;
+    ~conversion_server() {
+        std::error_code ec{};
+        fs::remove(socket_path_, ec);
+    }
+
+    [[nodiscard]] const fs::path& get_socket_path() const { return socket_path_; }
+
+    // Accepts connections until stopped
+    // Open connections are then shut down, and their threads joined, before returning
+    void run() {
+        std::array<pollfd, 2> fds{ { { listener_.get(), POLLIN, 0 }, { stop_reader_.get(), POLLIN, 0 } } };
+        while (true) {
+            remove_finished_connections();
+            if (::poll(fds.data(), fds.size(), -1) == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw socket_error{ "poll", errno };
+            }
+            if (fds[1].revents != 0) {
+                break;
+            }
+            if (fds[0].revents & POLLIN) {
+                accept_connection();
+            }
+        }
+        for (auto& c : connections_) {
+            ::shutdown(c.socket.get(), SHUT_RDWR);
+        }
+        connections_.clear();
+    }
+    // Makes run return
+    // Only writes to a pipe, so it can be called from another thread, or from a signal handler
+    void stop() noexcept {
+        char byte{ 0 };
+        [[maybe_unused]] auto n{ ::write(stop_writer_.get(), &byte, 1) };
+    }
+};
+
+
+// Sends conversion requests to a conversion server, over one connection
+class conversion_client {
+    file_descriptor socket_{};
+public:
+    explicit conversion_client(const fs::path& socket_path) {
+        auto address{ socket_io::make_address(socket_path, "connect") };
+        socket_ = file_descriptor{ ::socket(AF_UNIX, SOCK_STREAM, 0) };
+        if (socket_.get() == -1) {
+            throw socket_error{ "socket", errno };
+        }
+        if (::connect(socket_.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) {
+            throw socket_error{ "connect", errno };
+        }
+    }
+
+    // Returns the converted text
+    // Throws a conversion request error if the server could not convert the text
+    [[nodiscard]] std::string convert(std::string_view text) {
+        using namespace conversion_protocol;
+        if (text.size() > max_request_size) {
+            throw conversion_request_error{ fmt::format("request too large: {} bytes", text.size()) };
+        }
+        auto length{ encode_length(static_cast<uint32_t>(text.size())) };
+        if (not socket_io::write_all(socket_.get(), { length.data(), length.size() }) or
+            not socket_io::write_all(socket_.get(), text)) {
+            throw socket_error{ "send", errno };
+        }
+        std::array<char, 5> header{};
+        if (not socket_io::read_exactly(socket_.get(), header.data(), header.size())) {
+            throw socket_error{ "recv", ECONNRESET };
+        }
+        std::string ret(decode_length({ header[1], header[2], header[3], header[4] }), '\0');
+        if (not socket_io::read_exactly(socket_.get(), ret.data(), ret.size())) {
+            throw socket_error{ "recv", ECONNRESET };
+        }
+        if (static_cast<status_t>(header[0]) != status_t::ok) {
+            throw conversion_request_error{ ret };
+        }
+        return ret;
+    }
+};
+
+#endif  // _WIN32
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "input_reader.h"
+#include "translator.h"  // translation_counters
+
+#include <algorithm>  // max, min
+#include <chrono>
+#include <concepts>  // invocable
+#include <cstdint>  // uint64_t
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>  // invoke_result_t
+#include <utility>  // forward, move, pair
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <time.h>  // clock_gettime
+#endif
+
+
+// CPU time used so far by the calling thread, and by the whole process
+// Both clocks are monotonic, but reading them is a system call on most platforms, so they are read per stage, not per call
+#ifdef _WIN32
+namespace detail {
+    [[nodiscard]] inline std::chrono::nanoseconds to_nanoseconds(const FILETIME& kernel, const FILETIME& user) {
+        auto ticks = [](const FILETIME& t) {
+            return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+        };
+        return std::chrono::nanoseconds{ (ticks(kernel) + ticks(user)) * 100 };  // in 100 ns ticks
+    }
+}  // namespace detail
+[[nodiscard]] inline std::chrono::nanoseconds thread_cpu_time() {
+    FILETIME creation{}, exit{}, kernel{}, user{};
+    ::GetThreadTimes(::GetCurrentThread(), &creation, &exit, &kernel, &user);
+    return detail::to_nanoseconds(kernel, user);
+}
+[[nodiscard]] inline std::chrono::nanoseconds process_cpu_time() {
+    FILETIME creation{}, exit{}, kernel{}, user{};
+    ::GetProcessTimes(::GetCurrentProcess(), &creation, &exit, &kernel, &user);
+    return detail::to_nanoseconds(kernel, user);
+}
+#else
+namespace detail {
+    [[nodiscard]] inline std::chrono::nanoseconds cpu_time(clockid_t clock) {
+        timespec ts{};
+        ::clock_gettime(clock, &ts);
+        return std::chrono::seconds{ ts.tv_sec } + std::chrono::nanoseconds{ ts.tv_nsec };
+    }
+}  // namespace detail
+[[nodiscard]] inline std::chrono::nanoseconds thread_cpu_time() { return detail::cpu_time(CLOCK_THREAD_CPUTIME_ID); }
+[[nodiscard]] inline std::chrono::nanoseconds process_cpu_time() { return detail::cpu_time(CLOCK_PROCESS_CPUTIME_ID); }
+#endif
+
+
+// Time spent in, and work done by, one stage of a conversion
+struct stage_stats {
+    std::chrono::nanoseconds wall{};
+    std::optional<std::chrono::nanoseconds> cpu{};  // only known for stages running on threads of their own
+    uint64_t bytes{};  // read, converted, or written
+    uint64_t calls{};  // reads, sentences, or writes
+
+    // In MB/s, if any time was spent
+    [[nodiscard]] std::optional<double> get_throughput() const {
+        if (wall.count() <= 0) {
+            return std::nullopt;
+        }
+        return static_cast<double>(bytes) * 1e3 / static_cast<double>(wall.count());
+    }
+};
+
+
+// Report of a conversion, split into its reading, converting, and writing stages
+// The wall and CPU times of the whole conversion also account for the time spent between stages, e.g. opening files
+struct conversion_stats {
+    stage_stats read{};
+    stage_stats convert{};
+    stage_stats write{};
+    translation_counters counters{};
+    std::chrono::nanoseconds wall{};
+    std::chrono::nanoseconds cpu{};  // of the whole process
+};
+
+
+// One line per stage, and a last one with the translation counters
+inline std::ostream& operator<<(std::ostream& os, const conversion_stats& stats) {
+    using namespace std::chrono;
+    auto ms = [](nanoseconds t) { return fmt::format("{:.3f}", duration<double, std::milli>{ t }.count()); };
+    auto or_dash = [](const auto& value, auto&& format) { return value ? format(*value) : std::string{ "-" }; };
+    auto mb_per_s = [](double throughput) { return fmt::format("{:.1f}", throughput); };
+
+    os << fmt::format("{:<8} {:>12} {:>12} {:>14} {:>10} {:>10}\n", "stage", "wall (ms)", "cpu (ms)", "bytes", "calls", "MB/s");
+    for (auto [name, stage] : {
+        std::pair{ "read", &stats.read }, std::pair{ "convert", &stats.convert }, std::pair{ "write", &stats.write } }) {
+        os << fmt::format("{:<8} {:>12} {:>12} {:>14} {:>10} {:>10}\n",
+            name, ms(stage->wall), or_dash(stage->cpu, ms), stage->bytes, stage->calls, or_dash(stage->get_throughput(), mb_per_s));
+    }
+    os << fmt::format("{:<8} {:>12} {:>12}\n", "total", ms(stats.wall), ms(stats.cpu));
+    return os << fmt::format("sentences: {}, tokens: {}, number expressions: {}\n",
+        stats.counters.sentences, stats.counters.tokens, stats.counters.number_expressions);
+}
+template <>
+struct fmt::formatter<conversion_stats> : fmt::ostream_formatter {};
+
+
+// A single JSON object, on a single line, with times in nanoseconds
+// A CPU time that is not known is null
+[[nodiscard]] inline std::string to_json(const conversion_stats& stats) {
+    auto stage_to_json = [](const stage_stats& stage) {
+        return fmt::format(R"({{"wall_ns":{},"cpu_ns":{},"bytes":{},"calls":{}}})",
+            stage.wall.count(), stage.cpu ? std::to_string(stage.cpu->count()) : "null", stage.bytes, stage.calls);
+    };
+    return fmt::format(R"({{"wall_ns":{},"cpu_ns":{},"stages":{{"read":{},"convert":{},"write":{}}},)"
+        R"("sentences":{},"tokens":{},"number_expressions":{}}})",
+        stats.wall.count(), stats.cpu.count(),
+        stage_to_json(stats.read), stage_to_json(stats.convert), stage_to_json(stats.write),
+        stats.counters.sentences, stats.counters.tokens, stats.counters.number_expressions);
+}
+
+
+// Counts the calls to a stage, e.g. every read, and times them, into the stage's stats
+// Reading the steady clock can cost as much as a short call, e.g. reading a sentence from memory,
+// so only the first exact_calls calls are all timed; after that, one call in every sample_every is,
+// and the wall time of the stage is extrapolated from those samples
+// The cost of reading the clock itself is taken out of every sample
+class stage_timer {
+    static constexpr uint64_t exact_calls{ 1024 };
+    static constexpr uint64_t sample_every{ 64 };
+
+    using clock = std::chrono::steady_clock;
+
+    stage_stats& stats_;
+    std::chrono::nanoseconds sampled_wall_{};
+    uint64_t sampled_calls_{};
+private:
+    // Shortest time between two reads of the clock, measured once
+    [[nodiscard]] static clock::duration get_clock_overhead() {
+        static const auto ret{ []() {
+            auto min{ clock::duration::max() };
+            for (int i{ 0 }; i < 1000; ++i) {
+                auto start{ clock::now() };
+                min = std::min(min, clock::now() - start);
+            }
+            return min;
+        }() };
+        return ret;
+    }
+    void add_sample(clock::duration wall) {
+        sampled_wall_ += std::max(wall - get_clock_overhead(), clock::duration::zero());
+        ++sampled_calls_;
+        stats_.wall = sampled_wall_ * static_cast<int64_t>(stats_.calls) / static_cast<int64_t>(sampled_calls_);
+    }
+public:
+    explicit stage_timer(stage_stats& stats) : stats_{ stats } {}
+
+    // Bytes are counted by the caller, as they may only be known once the call returns
+    template <std::invocable F>
+    std::invoke_result_t<F> time(F&& call) {
+        auto n{ stats_.calls++ };
+        if (n >= exact_calls and n % sample_every != 0) {
+            return std::forward<F>(call)();
+        }
+        struct stopwatch {
+            stage_timer& timer;
+            clock::time_point start{ clock::now() };
+            ~stopwatch() { timer.add_sample(clock::now() - start); }
+        } sw{ *this };
+        return std::forward<F>(call)();
+    }
+};
+
+
+// Times the reads of another reader, and counts the bytes read, into a read stage
+class timed_reader : public input_reader {
+    input_reader_up reader_{};
+    stage_stats& stats_;
+    stage_timer timer_;
+public:
+    timed_reader(input_reader_up reader, stage_stats& stats)
+        : reader_{ std::move(reader) }
+        , stats_{ stats }
+        , timer_{ stats }
+    {}
+    std::string_view read() override {
+        auto ret{ timer_.time([this]() { return reader_->read(); }) };
+        stats_.bytes += ret.size();
+        return ret;
+    }
+    bool eof() override { return reader_->eof(); }
+    bool fail() override { return reader_->fail(); }
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "ast.h"  // number_to_word_map
+
+#include <array>
+#include <cctype>  // toupper
+#include <cstdint>  // int64_t, uint64_t
+#include <random>  // mt19937_64
+#include <string>
+#include <string_view>
+
+
+enum class magnitude_t {
+    hundreds,  // up to 999
+    thousands,  // up to 999 thousand
+    millions,  // up to 999 million
+    billions  // up to 999 billion
+};
+
+
+// Writes a number in words, e.g. 1'203 as "one thousand two hundred and three"
+// Tens and units are joined with a dash, e.g. "twenty-one", or with a space, e.g. "twenty one"
+[[nodiscard]] inline std::string number_to_words(int64_t number, bool dash = true) {
+    auto below_one_hundred = [dash](int n) {
+        if (n < 20) {
+            return number_to_word_map.at(n);
+        }
+        auto ret{ number_to_word_map.at(n / 10 * 10) };
+        if (n % 10 != 0) {
+            ret += (dash ? "-" : " ") + number_to_word_map.at(n % 10);
+        }
+        return ret;
+    };
+    auto below_one_thousand = [&below_one_hundred](int n) {
+        std::string ret{};
+        if (n >= 100) {
+            ret = number_to_word_map.at(n / 100) + " " + number_to_word_map.at(100);
+            if (n % 100 != 0) {
+                ret += " and ";
+            }
+        }
+        if (n % 100 != 0) {
+            ret += below_one_hundred(n % 100);
+        }
+        return ret;
+    };
+
+    if (number == 0) {
+        return number_to_word_map.at(0);
+    }
+    std::string ret{};
+    for (int64_t scale : { 1'000'000'000, 1'000'000, 1'000 }) {
+        if (auto group{ static_cast<int>(number / scale % 1'000) }; group != 0) {
+            ret += (ret.empty() ? "" : " ") + below_one_thousand(group) + " " + number_to_word_map.at(static_cast<int>(scale));
+        }
+    }
+    if (auto rest{ static_cast<int>(number % 1'000) }; rest != 0) {
+        if (ret.empty()) {
+            ret = below_one_thousand(rest);
+        } else if (rest < 100) {  // e.g. one thousand and three
+            ret += " and " + below_one_hundred(rest);
+        } else {
+            ret += " " + below_one_thousand(rest);
+        }
+    }
+    return ret;
+}
+
+
+struct corpus_options {
+    uint64_t seed{ 0 };
+    size_t words_per_sentence{ 12 };
+    int number_percent{ 10 };
+    magnitude_t max_magnitude{ magnitude_t::billions };
+};
+
+
+// Generates a synthetic text, sentence by sentence, together with its expected conversion
+// Every word of a sentence has a number_percent chance of being a number expression,
+// unless it follows a number expression, since two number expressions in a row would make a malformed sentence
+// Number expressions are built from number_to_word_map, and their number of digits is uniformly distributed
+// The same seed always generates the same text, on any platform
+class corpus_generator {
+    corpus_options options_{};
+    std::mt19937_64 engine_{};
+private:
+    static constexpr std::array prose_words{
+        "a", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "while", "its",
+        "owner", "reads", "another", "chapter", "of", "that", "old", "book", "at", "home",
+        "ledger", "balance", "due", "paid", "units", "item", "total", "per", "month", "account"
+    };
+    static constexpr int sentences_per_paragraph{ 8 };
+
+    // std::uniform_int_distribution is implementation defined, so it is not used
+    [[nodiscard]] uint64_t random(uint64_t n) {
+        return engine_() % n;
+    }
+    [[nodiscard]] int64_t random_number() {
+        static constexpr std::array<int64_t, 13> powers_of_ten{
+            1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000,
+            1'000'000'000, 10'000'000'000, 100'000'000'000, 1'000'000'000'000
+        };
+        auto max_digits{ 3 * (static_cast<uint64_t>(options_.max_magnitude) + 1) };
+        auto digits{ random(max_digits) + 1 };
+        auto min{ digits == 1 ? 0 : powers_of_ten[digits - 1] };
+        auto max{ powers_of_ten[digits] - 1 };
+        return min + static_cast<int64_t>(random(static_cast<uint64_t>(max - min + 1)));
+    }
+public:
+    explicit corpus_generator(const corpus_options& options)
+        : options_{ options }
+        , engine_{ options.seed }
+    {}
+
+    // Appends a sentence to input, and its conversion to expected_output
+    void next_sentence(std::string& input, std::string& expected_output) {
+        bool previous_is_number{ false };
+        for (size_t i{ 0 }; i < options_.words_per_sentence; ++i) {
+            std::string word{};
+            std::string converted_word{};
+            previous_is_number = not previous_is_number and random(100) < static_cast<uint64_t>(options_.number_percent);
+            if (previous_is_number) {
+                auto number{ random_number() };
+                word = number_to_words(number, random(2) == 0);
+                converted_word = std::to_string(number);
+            } else {
+                word = prose_words[random(prose_words.size())];
+            }
+            if (i == 0) {  // sentences start with an uppercase letter
+                word[0] = static_cast<char>(std::toupper(word[0]));
+            } else {
+                input += ' ';
+                expected_output += ' ';
+            }
+            input += word;
+            expected_output += previous_is_number ? converted_word : word;
+        }
+        std::string_view separator{ random(sentences_per_paragraph) == 0 ? ".\n" : ". " };
+        input += separator;
+        expected_output += separator;
+    }
+
+    // Generates sentences until the input text is at least size bytes long
+    void generate(size_t size, std::string& input, std::string& expected_output) {
+        while (input.size() < size) {
+            next_sentence(input, expected_output);
+        }
+    }
+};
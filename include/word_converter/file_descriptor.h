@@ -0,0 +1,37 @@
+#pragma once
+
+// File descriptors are only used on Unix-like systems
+#ifndef _WIN32
+
+#include <utility>  // exchange
+
+#include <unistd.h>  // close
+
+
+// Owns a file descriptor, and closes it on destruction
+class file_descriptor {
+    int fd_{ -1 };
+public:
+    file_descriptor() = default;
+    explicit file_descriptor(int fd) : fd_{ fd } {}
+    file_descriptor(const file_descriptor&) = delete;
+    file_descriptor& operator=(const file_descriptor&) = delete;
+    file_descriptor(file_descriptor&& other) noexcept : fd_{ std::exchange(other.fd_, -1) } {}
+    file_descriptor& operator=(file_descriptor&& other) noexcept {
+        if (this != &other) {
+            close();
+            fd_ = std::exchange(other.fd_, -1);
+        }
+        return *this;
+    }
+    ~file_descriptor() { close(); }
+
+    [[nodiscard]] int get() const { return fd_; }
+    void close() {
+        if (fd_ != -1) {
+            ::close(std::exchange(fd_, -1));
+        }
+    }
+};
+
+#endif  // _WIN32
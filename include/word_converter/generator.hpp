@@ -28,6 +28,18 @@
 #define NO_UNIQUE_ADDRESS [[no_unique_address]]
 #endif
 
+// Enclose a coroutine taking an allocator_arg: GCC wrongly warns, at the coroutine, that it pairs the allocator_arg
+// operator new of the promise with a mismatched operator delete
+#if defined(__GNUC__) && !defined(__clang__)
+#define BEGIN_ALLOCATOR_ARG_COROUTINE \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Wmismatched-new-delete\"")
+#define END_ALLOCATOR_ARG_COROUTINE _Pragma("GCC diagnostic pop")
+#else
+#define BEGIN_ALLOCATOR_ARG_COROUTINE
+#define END_ALLOCATOR_ARG_COROUTINE
+#endif
+
 namespace std {
     struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) _Aligned_block {
         unsigned char _Pad[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
@@ -1,10 +1,36 @@
 #pragma once
 
+#include "file_descriptor.h"
+#include "io_ring.h"
+
+#include <algorithm>  // min
+#include <cerrno>
+#include <cstdint>  // uint64_t
+#include <cstring>  // memchr
 #include <filesystem>
 #include <fmt/format.h>
 #include <fstream>
+#include <memory>  // unique_ptr
 #include <stdexcept>  // runtime_error
+#include <string>
+#include <string_view>
 #include <system_error>  // error_code
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>  // open, posix_fadvise
+#include <sys/mman.h>  // madvise, mmap, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>  // close
+#endif
 
 namespace fs = std::filesystem;
 
@@ -19,33 +45,54 @@ private:
 };
 
 
+struct could_not_map_file_error : public std::runtime_error {
+    explicit could_not_map_file_error(const fs::path& file_path) : std::runtime_error{ "" } {
+        message_ += fmt::format("'{}'", file_path.generic_string());
+    }
+    [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+private:
+    std::string message_{ "could not map file: " };
+};
+
+
 class input_reader {
 public:
     virtual ~input_reader() = default;
 
     // Read a sentence, i.e. until a period is found
     // or until the end of file, if no period is found
-    std::string read() {
+    // The returned view is only valid until the next read
+    virtual std::string_view read() = 0;
+    virtual bool eof() = 0;
+    virtual bool fail() = 0;
+};
+
+
+// Reads sentences from an input stream into a buffer owned by the reader
+class istream_reader : public input_reader {
+public:
+    std::string_view read() override {
         auto& is{ get_istream() };
-        std::string sentence{};
-        std::getline(is, sentence, '.');
+        std::getline(is, sentence_, '.');
         // It could happen that the last text in the stream does not end with a period
         // In that case, no period is added to the read text
         // Otherwise, std::getline stopped when finding a period
         // In that case, the period is added back to the read text
         if (not is.eof()) {
-            sentence += ".";
+            sentence_ += ".";
         }
-        return sentence;
+        return sentence_;
     }
-    auto eof() { return get_istream().eof(); }
-    auto fail() { return get_istream().fail(); }
+    bool eof() override { return get_istream().eof(); }
+    bool fail() override { return get_istream().fail(); }
 private:
+    std::string sentence_{};
+
     [[nodiscard]] virtual std::istream& get_istream() = 0;
 };
 
 
-class file_reader : public input_reader {
+class file_reader : public istream_reader {
 public:
     explicit file_reader(const fs::path& file_path) : ifs_{ file_path } {
         std::error_code ec{};
@@ -62,7 +109,7 @@ private:
 };
 
 
-class stream_reader : public input_reader {
+class stream_reader : public istream_reader {
 public:
     explicit stream_reader(std::istream& is) : is_{ is } {}
 private:
@@ -74,4 +121,276 @@ private:
 };
 
 
+// Reads sentences from a text held in memory
+// Sentences are returned as views into that text, so they are not copied
+class memory_reader : public input_reader {
+public:
+    explicit memory_reader(std::string_view text) : text_{ text } {}
+
+    std::string_view read() override {
+        if (pos_ == text_.size()) {
+            eof_ = true;
+            fail_ = true;
+            return {};
+        }
+        auto begin{ text_.data() + pos_ };
+        auto size{ text_.size() - pos_ };
+        if (auto period{ static_cast<const char*>(std::memchr(begin, '.', size)) }) {
+            size = static_cast<size_t>(period - begin) + 1;
+        } else {
+            eof_ = true;
+        }
+        pos_ += size;
+        return { begin, size };
+    }
+    bool eof() override { return eof_; }
+    bool fail() override { return fail_; }
+
+    // Whole text, regardless of how much of it has already been read
+    [[nodiscard]] std::string_view get_text() const { return text_; }
+protected:
+    memory_reader() = default;
+
+    void set_text(std::string_view text) { text_ = text; }
+private:
+    std::string_view text_{};
+    size_t pos_{};
+    bool eof_{};
+    bool fail_{};
+};
+
+
+// Maps a regular file into memory, and reads sentences straight from the mapped region
+// The kernel is told the region will be accessed sequentially
+class mapped_file_reader : public memory_reader {
+public:
+    explicit mapped_file_reader(const fs::path& file_path) {
+        std::error_code ec{};
+        if (not fs::is_regular_file(file_path, ec)) {
+            throw file_is_not_a_regular_file_error{ file_path };
+        }
+        auto size{ static_cast<size_t>(fs::file_size(file_path, ec)) };
+        if (ec) {
+            throw could_not_map_file_error{ file_path };
+        }
+        if (size == 0) {  // empty files cannot be mapped
+            return;
+        }
+        map(file_path, size);
+        set_text({ static_cast<const char*>(data_), size });
+    }
+    mapped_file_reader(const mapped_file_reader&) = delete;
+    mapped_file_reader& operator=(const mapped_file_reader&) = delete;
+    ~mapped_file_reader() override {
+        unmap();
+    }
+private:
+    void* data_{};
+#ifdef _WIN32
+    HANDLE file_{ INVALID_HANDLE_VALUE };
+    HANDLE mapping_{};
+
+    void map(const fs::path& file_path, size_t /* size */) {
+        file_ = ::CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ != INVALID_HANDLE_VALUE) {
+            mapping_ = ::CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_) {
+                data_ = ::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+            }
+        }
+        if (not data_) {
+            unmap();
+            throw could_not_map_file_error{ file_path };
+        }
+    }
+    void unmap() {
+        if (data_) {
+            ::UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            ::CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            ::CloseHandle(file_);
+        }
+    }
+#else
+    size_t size_{};
+
+    void map(const fs::path& file_path, size_t size) {
+        auto fd{ ::open(file_path.c_str(), O_RDONLY) };
+        if (fd == -1) {
+            throw could_not_map_file_error{ file_path };
+        }
+        auto data{ ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) };
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw could_not_map_file_error{ file_path };
+        }
+        data_ = data;
+        size_ = size;
+        ::madvise(data_, size_, MADV_SEQUENTIAL);
+        ::madvise(data_, size_, MADV_WILLNEED);
+    }
+    void unmap() {
+        if (data_) {
+            ::munmap(data_, size_);
+        }
+    }
+#endif
+};
+
+
+#ifndef _WIN32
+// Reads sentences from a regular file, keeping several large reads in flight on an io_ring
+// The file is read in blocks, into a ring of buffers: once a block has been consumed, its buffer is reused to read the
+// first block not asked for yet, so the kernel keeps reading ahead while the caller tokenizes the blocks already read
+// Sentences are returned as views into a block, and only copied if they span more than one block
+// Meant for files whose reads block, e.g. on network-attached storage, where a mapped file would stall on page faults
+class async_file_reader : public input_reader {
+public:
+    static constexpr size_t default_block_size{ size_t{ 1024 } * 1024 };
+    static constexpr size_t default_blocks{ 4 };
+private:
+    struct block {
+        std::vector<char> data{};
+        uint64_t offset{};  // in the file
+        size_t size{};  // asked for
+        size_t filled{};
+        bool ready{};
+    };
+
+    file_descriptor fd_{};
+    uint64_t file_size_{};
+    uint64_t next_offset_{};  // of the first block not asked for yet
+    uint64_t read_offset_{};  // of the first byte not returned yet
+    std::vector<block> blocks_{};
+    size_t current_{};  // block being consumed
+    size_t pos_{};  // in the current block
+    io_ring ring_;
+    std::string sentence_{};  // for sentences spanning more than one block
+    bool eof_{};
+    bool fail_{};
+private:
+    void read_block(size_t i) {
+        auto& b{ blocks_[i] };
+        b.offset = next_offset_;
+        b.size = static_cast<size_t>(std::min<uint64_t>(b.data.size(), file_size_ - next_offset_));
+        b.filled = 0;
+        b.ready = false;
+        next_offset_ += b.size;
+        ring_.read(fd_.get(), b.data.data(), b.size, b.offset, i);
+    }
+    // A short read asks for the rest of its block
+    void complete(const io_completion& completion) {
+        auto& b{ blocks_[completion.user_data] };
+        if (completion.result < 0) {
+            throw io_error{ "read", -completion.result };
+        }
+        if (completion.result == 0) {  // the file was truncated while being read
+            throw io_error{ "read", EIO };
+        }
+        b.filled += static_cast<size_t>(completion.result);
+        if (b.filled < b.size) {
+            ring_.read(fd_.get(), b.data.data() + b.filled, b.size - b.filled, b.offset + b.filled, completion.user_data);
+        } else {
+            b.ready = true;
+        }
+    }
+    [[nodiscard]] block& wait_for_current_block() {
+        auto& b{ blocks_[current_] };
+        while (not b.ready) {
+            complete(ring_.wait());
+        }
+        return b;
+    }
+    void next_block() {
+        if (next_offset_ < file_size_) {
+            read_block(current_);
+            ring_.submit();
+        }
+        current_ = (current_ + 1) % blocks_.size();
+        pos_ = 0;
+    }
+public:
+    // Falls back to synchronous reads, one block at a time, if the backend is not available
+    explicit async_file_reader(const fs::path& file_path, io_backend backend = io_backend::io_uring,
+        size_t block_size = default_block_size, size_t blocks = default_blocks)
+        : ring_{ static_cast<unsigned>(std::max<size_t>(blocks, 1)), backend } {
+
+        std::error_code ec{};
+        if (not fs::is_regular_file(file_path, ec)) {
+            throw file_is_not_a_regular_file_error{ file_path };
+        }
+        fd_ = file_descriptor{ ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC) };
+        struct stat st{};
+        if (fd_.get() == -1 or ::fstat(fd_.get(), &st) == -1) {
+            throw io_error{ "open", errno };
+        }
+        file_size_ = static_cast<uint64_t>(st.st_size);
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd_.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        // Small files do not need whole blocks
+        blocks_.resize(std::max<size_t>(blocks, 1));
+        for (auto& b : blocks_) {
+            b.data.resize(static_cast<size_t>(std::min<uint64_t>(std::max<size_t>(block_size, 1), file_size_)));
+        }
+        for (size_t i{ 0 }; i < blocks_.size() and next_offset_ < file_size_; ++i) {
+            read_block(i);
+        }
+        ring_.submit();
+    }
+    async_file_reader(const async_file_reader&) = delete;
+    async_file_reader& operator=(const async_file_reader&) = delete;
+    // Reads still in flight are waited for, so that the kernel does not write into freed buffers
+    ~async_file_reader() override {
+        try {
+            while (ring_.in_flight() > 0) {
+                (void) ring_.wait();
+            }
+        } catch (...) {}
+    }
+
+    std::string_view read() override {
+        sentence_.clear();
+        bool copied{ false };
+        while (true) {
+            if (read_offset_ == file_size_) {
+                eof_ = true;
+                fail_ = not copied;
+                return sentence_;
+            }
+            auto& b{ wait_for_current_block() };
+            if (pos_ == b.size) {
+                next_block();
+                continue;
+            }
+            auto begin{ b.data.data() + pos_ };
+            auto size{ b.size - pos_ };
+            auto period{ static_cast<const char*>(std::memchr(begin, '.', size)) };
+            if (period) {
+                size = static_cast<size_t>(period - begin) + 1;
+            }
+            pos_ += size;
+            read_offset_ += size;
+            if (period and not copied) {
+                return { begin, size };
+            }
+            sentence_.append(begin, size);
+            copied = true;
+            if (period) {
+                return sentence_;
+            }
+        }
+    }
+    bool eof() override { return eof_; }
+    bool fail() override { return fail_; }
+
+    [[nodiscard]] bool is_async() const { return ring_.is_async(); }
+};
+#endif  // _WIN32
+
+
 using input_reader_up = std::unique_ptr<input_reader>;
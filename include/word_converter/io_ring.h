@@ -0,0 +1,263 @@
+#pragma once
+
+// Positional reads and writes are only used on Unix-like systems
+#ifndef _WIN32
+
+#include "file_descriptor.h"
+
+#include <algorithm>  // max
+#include <atomic>  // atomic_ref
+#include <cerrno>
+#include <cstdint>  // uint8_t, uint32_t, uint64_t
+#include <deque>
+#include <fmt/format.h>
+#include <stdexcept>  // runtime_error
+#include <string>
+#include <system_error>  // system_category
+#include <utility>  // move
+#include <sys/types.h>  // off_t
+#include <unistd.h>  // pread, pwrite
+
+// io_uring is used if the Linux headers declare it, and the running kernel lets it be set up
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define WORD_CONVERTER_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/syscall.h>  // SYS_io_uring_enter, SYS_io_uring_setup
+#endif
+
+
+struct io_error : public std::runtime_error {
+    io_error(const std::string& operation, int error) : std::runtime_error{ "" } {
+        message_ += fmt::format("'{}': {}", operation, std::system_category().message(error));
+    }
+    [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+private:
+    std::string message_{ "I/O error: " };
+};
+
+
+enum class io_backend {
+    io_uring,  // falls back to sync if io_uring is not available
+    sync
+};
+
+
+// Result of a read or a write: the number of bytes transferred, or a negated errno
+struct io_completion {
+    uint64_t user_data{};
+    int result{};
+};
+
+
+// Queue of reads and writes at explicit file offsets
+// With an io_uring, operations are queued in its submission ring, submitted together, and run by the kernel,
+// while the caller goes on, e.g. tokenizing the blocks already read; the caller waits for their completions later on
+// Without one, every operation is run when queued, with pread or pwrite, and its completion kept until waited for
+// Either way, as with the kernel, a read or a write can transfer fewer bytes than asked for
+// Buffers must outlive the operations using them, i.e. until their completions are waited for
+class io_ring {
+    size_t in_flight_{ 0 };
+    std::deque<io_completion> completions_{};  // sync backend
+
+#ifdef WORD_CONVERTER_HAS_IO_URING
+    file_descriptor ring_fd_{};
+    io_uring_params params_{};
+    void* sq_ring_{ MAP_FAILED };
+    size_t sq_ring_size_{};
+    io_uring_sqe* sqes_{ static_cast<io_uring_sqe*>(MAP_FAILED) };
+    size_t sqes_size_{};
+    unsigned* sq_head_{};
+    unsigned* sq_tail_{};
+    unsigned* sq_array_{};
+    unsigned* cq_head_{};
+    unsigned* cq_tail_{};
+    io_uring_cqe* cqes_{};
+    unsigned to_submit_{ 0 };
+#endif
+private:
+#ifdef WORD_CONVERTER_HAS_IO_URING
+    // The kernel reads the submission ring tail and writes the completion ring tail concurrently
+    [[nodiscard]] static unsigned load_acquire(unsigned* p) {
+        return std::atomic_ref<unsigned>{ *p }.load(std::memory_order_acquire);
+    }
+    static void store_release(unsigned* p, unsigned value) {
+        std::atomic_ref<unsigned>{ *p }.store(value, std::memory_order_release);
+    }
+    [[nodiscard]] static void* map(int fd, size_t size, off_t offset) {
+        return ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    }
+    // Leaves the ring unset, so the sync backend is used, if the kernel does not let it be set up
+    void set_up(unsigned entries) {
+        file_descriptor fd{ static_cast<int>(::syscall(SYS_io_uring_setup, entries, &params_)) };
+        if (fd.get() < 0 or not (params_.features & IORING_FEAT_SINGLE_MMAP)) {
+            return;
+        }
+        // Both rings are mapped at once
+        sq_ring_size_ = std::max(params_.sq_off.array + params_.sq_entries * sizeof(unsigned),
+            params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe));
+        sq_ring_ = map(fd.get(), sq_ring_size_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            return;
+        }
+        sqes_size_ = params_.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(fd.get(), sqes_size_, IORING_OFF_SQES));
+        if (sqes_ == MAP_FAILED) {
+            tear_down();
+            return;
+        }
+        auto sq{ static_cast<char*>(sq_ring_) };
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.tail);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params_.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(sq + params_.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(sq + params_.cq_off.tail);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(sq + params_.cq_off.cqes);
+        ring_fd_ = std::move(fd);
+    }
+    void tear_down() {
+        if (sqes_ != MAP_FAILED) {
+            ::munmap(sqes_, sqes_size_);
+            sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+        }
+        if (sq_ring_ != MAP_FAILED) {
+            ::munmap(sq_ring_, sq_ring_size_);
+            sq_ring_ = MAP_FAILED;
+        }
+        ring_fd_.close();
+    }
+    // Submits the queued operations and, if asked to, waits for at least one completion
+    void enter(unsigned min_complete) {
+        while (true) {
+            auto n{ ::syscall(SYS_io_uring_enter, ring_fd_.get(), to_submit_, min_complete,
+                min_complete > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0) };
+            if (n >= 0) {
+                to_submit_ -= static_cast<unsigned>(n);
+                if (to_submit_ == 0 or min_complete > 0) {
+                    return;
+                }
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            throw io_error{ "io_uring_enter", errno };
+        }
+    }
+    [[nodiscard]] bool try_reap(io_completion& completion) {
+        auto head{ *cq_head_ };
+        if (head == load_acquire(cq_tail_)) {
+            return false;
+        }
+        const auto& cqe{ cqes_[head & (params_.cq_entries - 1)] };
+        completion = { cqe.user_data, cqe.res };
+        store_release(cq_head_, head + 1);
+        return true;
+    }
+    void push(uint8_t opcode, int fd, const char* data, size_t size, uint64_t offset, uint64_t user_data) {
+        auto tail{ *sq_tail_ };
+        if (tail - load_acquire(sq_head_) == params_.sq_entries) {
+            enter(0);
+        }
+        auto index{ tail & (params_.sq_entries - 1) };
+        auto& sqe{ sqes_[index] };
+        sqe = {};
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(data);
+        sqe.len = static_cast<uint32_t>(size);
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        sq_array_[index] = index;
+        store_release(sq_tail_, tail + 1);
+        ++to_submit_;
+    }
+#endif
+
+    template <typename F>
+    void run_sync(F&& f, uint64_t user_data) {
+        ssize_t n{};
+        do {
+            n = f();
+        } while (n == -1 and errno == EINTR);
+        completions_.push_back({ user_data, n == -1 ? -errno : static_cast<int>(n) });
+    }
+public:
+    // At most entries operations should be in flight at any time
+    explicit io_ring(unsigned entries, io_backend backend = io_backend::io_uring) {
+#ifdef WORD_CONVERTER_HAS_IO_URING
+        if (backend == io_backend::io_uring) {
+            set_up(entries);
+        }
+#else
+        (void) entries; (void) backend;
+#endif
+    }
+    io_ring(const io_ring&) = delete;
+    io_ring& operator=(const io_ring&) = delete;
+    // Operations still in flight must have been waited for
+    ~io_ring() {
+#ifdef WORD_CONVERTER_HAS_IO_URING
+        tear_down();
+#endif
+    }
+
+    [[nodiscard]] bool is_async() const {
+#ifdef WORD_CONVERTER_HAS_IO_URING
+        return ring_fd_.get() != -1;
+#else
+        return false;
+#endif
+    }
+    [[nodiscard]] size_t in_flight() const { return in_flight_; }
+
+    void read(int fd, char* data, size_t size, uint64_t offset, uint64_t user_data) {
+        ++in_flight_;
+#ifdef WORD_CONVERTER_HAS_IO_URING
+        if (is_async()) {
+            push(IORING_OP_READ, fd, data, size, offset, user_data);
+            return;
+        }
+#endif
+        run_sync([=]() { return ::pread(fd, data, size, static_cast<off_t>(offset)); }, user_data);
+    }
+    void write(int fd, const char* data, size_t size, uint64_t offset, uint64_t user_data) {
+        ++in_flight_;
+#ifdef WORD_CONVERTER_HAS_IO_URING
+        if (is_async()) {
+            push(IORING_OP_WRITE, fd, data, size, offset, user_data);
+            return;
+        }
+#endif
+        run_sync([=]() { return ::pwrite(fd, data, size, static_cast<off_t>(offset)); }, user_data);
+    }
+    // Starts the queued operations, without waiting for them
+    void submit() {
+#ifdef WORD_CONVERTER_HAS_IO_URING
+        if (is_async() and to_submit_ > 0) {
+            enter(0);
+        }
+#endif
+    }
+    // Submits the queued operations, and returns the first completion, waiting for it if needed
+    // Must not be called without operations in flight
+    [[nodiscard]] io_completion wait() {
+        io_completion ret{};
+#ifdef WORD_CONVERTER_HAS_IO_URING
+        if (is_async()) {
+            submit();
+            while (not try_reap(ret)) {
+                enter(1);
+            }
+            --in_flight_;
+            return ret;
+        }
+#endif
+        ret = completions_.front();
+        completions_.pop_front();
+        --in_flight_;
+        return ret;
+    }
+};
+
+#endif  // _WIN32
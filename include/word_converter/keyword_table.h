@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>  // equal
+#include <array>
+#include <cstdint>  // uint8_t, uint32_t
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+
+enum class lexeme_t {
+    zero,
+    one,
+    two_to_nine,  // two, three, four, five, six, seven, eight, nine
+    ten_to_nineteen,  // ten, eleven, twelve, thirteen, fourteen, fifteen, sixteen, seventeen, eighteen, nineteen
+    tens,  // twenty, thirty, forty, fifty, sixty, seventy, eighty, ninety
+    hundred,  // a hundred
+    thousand,  // a thousand
+    million,  // a million
+    billion,  // a billion
+    and_connector,  // and
+    space,  // whitespace, tab, newline...
+    dash,  // '-'
+    period, // '.'
+    other,  // anything else, whatever is not allowed in a word number expression
+    end
+};
+inline std::ostream& operator<<(std::ostream& os, const lexeme_t& l) {
+    switch (l) {
+        case lexeme_t::zero: os << "zero"; break;
+        case lexeme_t::one: os << "one"; break;
+        case lexeme_t::two_to_nine: os << "two_to_nine"; break;
+        case lexeme_t::ten_to_nineteen: os << "ten_to_nineteen"; break;
+        case lexeme_t::tens: os << "tens"; break;
+        case lexeme_t::hundred: os << "hundred"; break;
+        case lexeme_t::thousand: os << "thousand"; break;
+        case lexeme_t::million: os << "million"; break;
+        case lexeme_t::billion: os << "billion"; break;
+        case lexeme_t::and_connector: os << "and"; break;
+        case lexeme_t::dash: os << "dash"; break;
+        case lexeme_t::period: os << "period"; break;
+        case lexeme_t::space: os << "space"; break;
+        case lexeme_t::other: os << "other"; break;
+        case lexeme_t::end: os << "end"; break;
+    }
+    return os;
+}
+template <>
+struct fmt::formatter<lexeme_t> : fmt::ostream_formatter {};
+
+
+struct keyword_t {
+    std::string_view word{};
+    lexeme_t lexeme{};
+    int value{};
+};
+
+
+inline constexpr std::array keywords{
+    keyword_t{ "zero", lexeme_t::zero, 0 },  // zero
+    keyword_t{ "one", lexeme_t::one, 1 },  // one
+    keyword_t{ "two", lexeme_t::two_to_nine, 2 },  // two to nine
+    keyword_t{ "three", lexeme_t::two_to_nine, 3 },
+    keyword_t{ "four", lexeme_t::two_to_nine, 4 },
+    keyword_t{ "five", lexeme_t::two_to_nine, 5 },
+    keyword_t{ "six", lexeme_t::two_to_nine, 6 },
+    keyword_t{ "seven", lexeme_t::two_to_nine, 7 },
+    keyword_t{ "eight", lexeme_t::two_to_nine, 8 },
+    keyword_t{ "nine", lexeme_t::two_to_nine, 9 },
+    keyword_t{ "ten", lexeme_t::ten_to_nineteen, 10 },  // ten to nineteen
+    keyword_t{ "eleven", lexeme_t::ten_to_nineteen, 11 },
+    keyword_t{ "twelve", lexeme_t::ten_to_nineteen, 12 },
+    keyword_t{ "thirteen", lexeme_t::ten_to_nineteen, 13 },
+    keyword_t{ "fourteen", lexeme_t::ten_to_nineteen, 14 },
+    keyword_t{ "fifteen", lexeme_t::ten_to_nineteen, 15 },
+    keyword_t{ "sixteen", lexeme_t::ten_to_nineteen, 16 },
+    keyword_t{ "seventeen", lexeme_t::ten_to_nineteen, 17 },
+    keyword_t{ "eighteen", lexeme_t::ten_to_nineteen, 18 },
+    keyword_t{ "nineteen", lexeme_t::ten_to_nineteen, 19 },
+    keyword_t{ "twenty", lexeme_t::tens, 20 },  // tens
+    keyword_t{ "thirty", lexeme_t::tens, 30 },
+    keyword_t{ "forty", lexeme_t::tens, 40 },
+    keyword_t{ "fifty", lexeme_t::tens, 50 },
+    keyword_t{ "sixty", lexeme_t::tens, 60 },
+    keyword_t{ "seventy", lexeme_t::tens, 70 },
+    keyword_t{ "eighty", lexeme_t::tens, 80 },
+    keyword_t{ "ninety", lexeme_t::tens, 90 },
+    keyword_t{ "hundred", lexeme_t::hundred, 100 },  // a hundred
+    keyword_t{ "thousand", lexeme_t::thousand, 1'000 },  // a thousand
+    keyword_t{ "million", lexeme_t::million, 1'000'000 },  // a million
+    keyword_t{ "billion", lexeme_t::billion, 1'000'000'000 },  // a billion
+    keyword_t{ "and", lexeme_t::and_connector, 0 }  // and
+};
+
+
+// Case-insensitive and allocation-free lookup of keywords
+// Keywords are uniquely identified by their length, their first two letters, and their last letter
+// The hash of that key uses a seed, searched at compile time, for which there are no collisions
+namespace keyword_table {
+
+namespace detail {
+    inline constexpr size_t min_word_length{ 3 };
+    inline constexpr size_t max_word_length{ 9 };
+    inline constexpr size_t number_of_slots{ 128 };
+    inline constexpr uint8_t empty_slot{ 0xff };
+
+    using slots_t = std::array<uint8_t, number_of_slots>;
+
+    // Setting the 0x20 bit lowercases an uppercase ASCII letter, and leaves a lowercase one untouched
+    [[nodiscard]] constexpr uint32_t to_lower(char c) {
+        return static_cast<uint8_t>(c) | 0x20u;
+    }
+    [[nodiscard]] constexpr uint32_t key(std::string_view word) {
+        return static_cast<uint32_t>(word.size()) |
+            (to_lower(word[0]) << 8) |
+            (to_lower(word[1]) << 16) |
+            (to_lower(word.back()) << 24);
+    }
+    // MurmurHash3 finalizer
+    [[nodiscard]] constexpr size_t hash(uint32_t key, uint32_t seed) {
+        uint32_t h{ key ^ seed };
+        h ^= h >> 16;
+        h *= 0x85eb'ca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2'ae35u;
+        h ^= h >> 16;
+        return h % number_of_slots;
+    }
+    [[nodiscard]] constexpr std::optional<slots_t> build_slots(uint32_t seed) {
+        slots_t slots{};
+        slots.fill(empty_slot);
+        for (uint8_t i{ 0 }; i < keywords.size(); ++i) {
+            auto& slot{ slots[hash(key(keywords[i].word), seed)] };
+            if (slot != empty_slot) {
+                return std::nullopt;
+            }
+            slot = i;
+        }
+        return slots;
+    }
+    [[nodiscard]] constexpr uint32_t find_seed() {
+        uint32_t seed{ 0 };
+        while (not build_slots(seed).has_value()) {
+            ++seed;
+        }
+        return seed;
+    }
+
+    inline constexpr uint32_t seed{ find_seed() };
+    inline constexpr slots_t slots{ build_slots(seed).value() };
+}  // namespace detail
+
+// Returns the keyword matching a word, or a null pointer if the word is not a keyword
+[[nodiscard]] constexpr const keyword_t* find(std::string_view word) {
+    using namespace detail;
+    if (word.size() < min_word_length or word.size() > max_word_length) {
+        return nullptr;
+    }
+    auto slot{ slots[hash(key(word), seed)] };
+    if (slot == empty_slot) {
+        return nullptr;
+    }
+    const auto& keyword{ keywords[slot] };
+    if (not std::ranges::equal(word, keyword.word, [](char c, char k) { return to_lower(c) == static_cast<uint8_t>(k); })) {
+        return nullptr;
+    }
+    return &keyword;
+}
+
+}  // namespace keyword_table
@@ -2,178 +2,158 @@
 
 #include "generator.hpp"
 #include "input_reader.h"
+#include "keyword_table.h"
+#include "prefilter.h"
+#include "trace.h"
 
-#include <cstdint>  // int64_t
+#include <algorithm>  // for_each, min
 #include <fmt/format.h>
 #include <fmt/ostream.h>
-#include <regex>
-#include <rtc/string.h>
+#include <memory>  // allocator_arg
+#include <memory_resource>  // polymorphic_allocator, unsynchronized_pool_resource
 #include <ostream>
-#include <unordered_map>
 #include <string>
 #include <string_view>
 
 
-enum class lexeme_t {
-    zero,
-    one,
-    two_to_nine,  // two, three, four, five, six, seven, eight, nine
-    ten_to_nineteen,  // ten, eleven, twelve, thirteen, fourteen, fifteen, sixteen, seventeen, eighteen, nineteen
-    tens,  // twenty, thirty, forty, fifty, sixty, seventy, eighty, ninety
-    hundred,  // a hundred
-    thousand,  // a thousand
-    million,  // a million
-    billion,  // a billion
-    and_connector,  // and
-    space,  // whitespace, tab, newline...
-    dash,  // '-'
-    period, // '.'
-    other,  // anything else, whatever is not allowed in a word number expression
-    end
-};
-inline std::ostream& operator<<(std::ostream& os, const lexeme_t& l) {
-    switch (l) {
-        case lexeme_t::zero: os << "zero"; break;
-        case lexeme_t::one: os << "one"; break;
-        case lexeme_t::two_to_nine: os << "two_to_nine"; break;
-        case lexeme_t::ten_to_nineteen: os << "ten_to_nineteen"; break;
-        case lexeme_t::tens: os << "tens"; break;
-        case lexeme_t::hundred: os << "hundred"; break;
-        case lexeme_t::thousand: os << "thousand"; break;
-        case lexeme_t::million: os << "million"; break;
-        case lexeme_t::billion: os << "billion"; break;
-        case lexeme_t::and_connector: os << "and"; break;
-        case lexeme_t::dash: os << "dash"; break;
-        case lexeme_t::period: os << "period"; break;
-        case lexeme_t::space: os << "space"; break;
-        case lexeme_t::other: os << "other"; break;
-        case lexeme_t::end: os << "end"; break;
-    }
-    return os;
+// Writes new lines, carriage returns, and tabs as escape sequences, e.g. a new line as \n
+[[nodiscard]] inline std::string escape_escape_sequences(std::string_view str) {
+    static const std::string escape_sequences{ "\n\r\t" };
+    static const std::string substitutions{ "nrt" };
+    std::string ret{};
+    std::ranges::for_each(str, [&ret](char c) {
+        if (auto pos{ escape_sequences.find(c) }; pos != std::string::npos) {
+            ret += std::string{ '\\', substitutions[pos] };
+        } else {
+            ret += c;
+        }
+    });
+    return ret;
 }
-template <>
-struct fmt::formatter<lexeme_t> : fmt::ostream_formatter {};
 
 
+// The text of a token is a view into the sentence buffer owned by the input reader
+// It is only valid until the tokenizer reads the next sentence
 struct token_t {
     lexeme_t lexeme{};
-    std::string text{};
+    std::string_view text{};
+    int value{};  // only meaningful for number words
+
+    [[nodiscard]] bool operator==(const token_t& other) const = default;
 };
 inline std::ostream& operator<<(std::ostream& os, const token_t& t) {
-    auto escape_escape_sequences = [](std::string str) {
-        static const std::string escape_sequences{ "\n\r\t" };
-        static const std::string substitutions{ "nrt" };
-        std::string ret{};
-        std::ranges::for_each(str, [&ret](char c) {
-            if (auto pos{ escape_sequences.find(c) }; pos != std::string::npos) {
-                ret += std::string{ '\\', substitutions[pos] };
-            } else {
-                ret += c;
-            }
-        });
-        return ret;
-    };
     return os << fmt::format("({}, '{}')", t.lexeme, escape_escape_sequences(t.text));
 }
 template <>
 struct fmt::formatter<token_t> : fmt::ostream_formatter {};
 
 
-inline static const std::unordered_map<std::string, lexeme_t> word_to_lexeme_map{
-    { "zero", lexeme_t::zero },  // zero
-    { "one", lexeme_t::one },  // one
-    { "two", lexeme_t::two_to_nine },  // two to nine
-    { "three", lexeme_t::two_to_nine },
-    { "four", lexeme_t::two_to_nine },
-    { "five", lexeme_t::two_to_nine },
-    { "six", lexeme_t::two_to_nine },
-    { "seven", lexeme_t::two_to_nine },
-    { "eight", lexeme_t::two_to_nine },
-    { "nine", lexeme_t::two_to_nine },
-    { "ten", lexeme_t::ten_to_nineteen },  // ten to nineteen
-    { "eleven", lexeme_t::ten_to_nineteen },
-    { "twelve", lexeme_t::ten_to_nineteen },
-    { "thirteen", lexeme_t::ten_to_nineteen },
-    { "fourteen", lexeme_t::ten_to_nineteen },
-    { "fifteen", lexeme_t::ten_to_nineteen },
-    { "sixteen", lexeme_t::ten_to_nineteen },
-    { "seventeen", lexeme_t::ten_to_nineteen },
-    { "eighteen", lexeme_t::ten_to_nineteen },
-    { "nineteen", lexeme_t::ten_to_nineteen },
-    { "twenty", lexeme_t::tens },  // tens
-    { "thirty", lexeme_t::tens },
-    { "forty", lexeme_t::tens },
-    { "fifty", lexeme_t::tens },
-    { "sixty", lexeme_t::tens },
-    { "seventy", lexeme_t::tens },
-    { "eighty", lexeme_t::tens },
-    { "ninety", lexeme_t::tens },
-    { "hundred", lexeme_t::hundred },  // a hundred
-    { "thousand", lexeme_t::thousand },  // a thousand
-    { "million", lexeme_t::million },  // a million
-    { "billion", lexeme_t::billion },  // a billion
-    { "and", lexeme_t::and_connector }  // and
-};
-
-
 class tokenizer {
     input_reader_up reader_{};
+
+    // Sentence being tokenized, and its offset in the input, in bytes
+    std::string_view sentence_{};
+    size_t sentence_offset_{ 0 };
+
+    // Pool for the coroutine frames of get_next_token
+    // A frame is created for every sentence, and given back to the pool once the sentence has been tokenized,
+    // so the same block of memory is reused for all the sentences
+    std::pmr::unsynchronized_pool_resource frame_pool_{};
 private:
-    [[nodiscard]] static std::generator<token_t> get_next_token(std::string sentence) {
-        std::string_view space_pattern{ R"([ \t\r\n]+)" };
-        std::string_view dash_pattern{ R"(\-)" };
-        std::string_view period_pattern{ R"(\.)" };
-        std::string_view word_pattern{ R"([a-zA-Z]+)" };
-        static const std::regex pattern{ fmt::format("({})|({})|({})|({})",
-            space_pattern,  // 1
-            dash_pattern,  // 2
-            period_pattern,  // 3
-            word_pattern  // 4
-        )};
-        std::smatch sm{};
-        while (std::regex_search(sentence, sm, pattern)) {
-            const auto& prefix{ sm.prefix().str() };
-            if (not prefix.empty()) {  // other
-                token_t ret{ lexeme_t::other, prefix };
-                co_yield ret;
+    [[nodiscard]] static constexpr bool is_space(char c) {
+        return c == ' ' or c == '\t' or c == '\r' or c == '\n';
+    }
+    [[nodiscard]] static constexpr bool is_letter(char c) {
+        return ('a' <= c and c <= 'z') or ('A' <= c and c <= 'Z');
+    }
+    // Single pass over the sentence
+    // Candidate words, periods, and the spaces and dashes following them, are matched by their first character
+    // Whatever text sits in between them is yielded as a single 'other' token
+    //
+    // Candidate words are found with the prefilter, which skips over words that cannot be keywords
+    // The spaces and dashes right after a number word are the only text the parser treats differently from 'other' text
+    // The ones right after a period are kept as well, since the parser moves them to the end of the previous sentence
+    //
+    // The coroutine frame is allocated with the given allocator
+    BEGIN_ALLOCATOR_ARG_COROUTINE
+    [[nodiscard]] static std::generator<token_t> get_next_token(std::allocator_arg_t, std::pmr::polymorphic_allocator<>,
+        std::string_view text) {
+        auto scan_while = [&text](size_t pos, auto predicate) {
+            while (pos < text.size() and predicate(text[pos])) {
+                ++pos;
+            }
+            return pos;
+        };
+        size_t next_candidate{ prefilter::find_candidate(text, 0) };
+        size_t next_period{ text.find('.') };
+        bool after_candidate_or_period{ true };
+        for (size_t pos{ 0 }; pos < text.size(); ) {
+            if (next_candidate < pos) {
+                next_candidate = prefilter::find_candidate(text, pos);
             }
-            if (sm[1].matched) {  // space
-                token_t ret{ lexeme_t::space, sm[1].str() };
+            if (next_period < pos) {
+                next_period = text.find('.', pos);
+            }
+            auto c{ text[pos] };
+            if (after_candidate_or_period and is_space(c)) {  // space
+                auto end{ scan_while(pos, is_space) };
+                token_t ret{ lexeme_t::space, text.substr(pos, end - pos) };
+                pos = end;
                 co_yield ret;
-            } else if (sm[2].matched) {  // dash
-                token_t ret{ lexeme_t::dash, sm[2].str() };
+            } else if (after_candidate_or_period and c == '-') {  // dash
+                token_t ret{ lexeme_t::dash, text.substr(pos++, 1) };
                 co_yield ret;
-            } else if (sm[3].matched) {  // period
-                token_t ret{ lexeme_t::period, sm[3].str() };
+            } else if (pos == next_period) {  // period
+                token_t ret{ lexeme_t::period, text.substr(pos++, 1) };
+                after_candidate_or_period = true;
                 co_yield ret;
-            } else if (sm[4].matched) {  // word
-                const auto &word{ sm[4].str() };
-                auto word_lc{ rtc::string::to_lowercase(word) };
-                if (word_to_lexeme_map.contains(word_lc)) {
-                    token_t ret{ word_to_lexeme_map.at(word_lc), word };
+            } else if (pos == next_candidate) {  // word
+                auto end{ scan_while(pos, is_letter) };
+                auto word{ text.substr(pos, end - pos) };
+                pos = end;
+                after_candidate_or_period = true;
+                if (auto keyword{ keyword_table::find(word) }) {
+                    token_t ret{ keyword->lexeme, word, keyword->value };
                     co_yield ret;
                 } else {
                     token_t ret{ lexeme_t::other, word };
                     co_yield ret;
                 }
+            } else {  // other
+                auto end{ std::min({ next_candidate, next_period, text.size() }) };
+                token_t ret{ lexeme_t::other, text.substr(pos, end - pos) };
+                pos = end;
+                after_candidate_or_period = false;
+                co_yield ret;
             }
-            sentence = sm.suffix();
-        }
-        if (not sentence.empty()) {  // other
-            token_t ret{ lexeme_t::other, sentence };
-            co_yield ret;
         }
     }
+    END_ALLOCATOR_ARG_COROUTINE
 public:
     explicit tokenizer(input_reader_up reader)
         : reader_{ std::move(reader) }
     {}
+    // Tokenizes a new input, keeping the pool of coroutine frames
+    // Generators returned before the reset must not be used any more
+    void reset(input_reader_up reader) {
+        reader_ = std::move(reader);
+        sentence_ = {};
+        sentence_offset_ = 0;
+    }
+    // Text of the sentence the last token was read from, e.g. to copy a malformed sentence through unchanged
+    // Like the text of a token, it is only valid until the next sentence is read
+    [[nodiscard]] std::string_view get_current_sentence() const { return sentence_; }
+    [[nodiscard]] size_t get_current_sentence_offset() const { return sentence_offset_; }
+    // The tokens of every sentence are yielded straight from get_next_token, as elements of a nested generator,
+    // so the caller resumes get_next_token directly, instead of going through this coroutine for every token
     [[nodiscard]] std::generator<token_t> operator()() {
         while (not reader_->eof()) {
-            std::string sentence{ reader_->read() };
-            for (auto&& token : get_next_token(std::move(sentence))) {
-                co_yield token;
+            sentence_offset_ += sentence_.size();
+            {
+                WORD_CONVERTER_TRACE_SPAN("read", sentence_offset_);
+                sentence_ = reader_->read();
             }
+            co_yield std::ranges::elements_of(get_next_token(std::allocator_arg, &frame_pool_, sentence_));
         }
         token_t ret{ lexeme_t::end, {} };
         co_yield ret;
@@ -191,6 +171,7 @@ private:
     generator_iter_t current_token_it_;
     generator_sentinel_t end_token_it_;
     token_t current_token_;
+    size_t token_count_{};
 public:
     explicit lexer(input_reader_up reader)
         : tokenizer_{ std::move(reader) }
@@ -198,19 +179,41 @@ public:
         , current_token_it_{ token_generator_.begin() }
         , end_token_it_{ token_generator_.end() }
         , current_token_{ *current_token_it_ }
+        , token_count_{ current_token_.lexeme != lexeme_t::end ? size_t{ 1 } : size_t{ 0 } }
     {}
+    // Starts over with a new input, e.g. the next request of a conversion server
+    void reset(input_reader_up reader) {
+        tokenizer_.reset(std::move(reader));
+        token_generator_ = tokenizer_();
+        current_token_it_ = token_generator_.begin();
+        end_token_it_ = token_generator_.end();
+        current_token_ = *current_token_it_;
+        token_count_ = (current_token_.lexeme != lexeme_t::end ? 1 : 0);
+    }
     void advance_to_next_token() {
         if (++current_token_it_ != end_token_it_) {
             current_token_ = *current_token_it_;
+            token_count_ += (current_token_.lexeme != lexeme_t::end ? 1 : 0);
         }
     }
-    [[nodiscard]] auto get_current_token() const {
+    [[nodiscard]] const token_t& get_current_token() const {
         return current_token_;
     }
-    [[nodiscard]] auto get_current_lexeme() const {
+    [[nodiscard]] lexeme_t get_current_lexeme() const {
         return current_token_.lexeme;
     }
-    [[nodiscard]] auto get_current_text() const {
+    [[nodiscard]] std::string_view get_current_text() const {
         return current_token_.text;
     }
+    [[nodiscard]] std::string_view get_current_sentence() const {
+        return tokenizer_.get_current_sentence();
+    }
+    [[nodiscard]] size_t get_current_sentence_offset() const {
+        return tokenizer_.get_current_sentence_offset();
+    }
+    // Number of tokens read so far, not counting the end token
+    // Sentences are tokenized on their own, so the counts of the chunks of a text add up to that of the whole text
+    [[nodiscard]] size_t get_token_count() const {
+        return token_count_;
+    }
 };
@@ -0,0 +1,314 @@
+#pragma once
+
+#include "keyword_table.h"  // lexeme_t
+
+#include <array>
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t
+#include <initializer_list>
+
+
+// Number expressions, from 'billions' down to 'one_to_nine' in grammar.ebnf, compiled into a state machine
+//
+// The machine is fed the lexemes of a number expression, one at a time, spaces left out
+// Every lexeme takes the machine to a new state, consuming the lexeme, or ends the expression, without consuming it:
+// - accept: the expression ends right before the lexeme,
+// - reject: the expression is malformed
+// Each lexeme is examined exactly once, with a single table lookup
+//
+// The transitions are those of the parser's recursive-descent functions, including their lack of backtracking
+// (e.g. 'one hundred and two hundred' is a single expression, and 'twenty-' must be followed by a number word)
+// Every state is named after the shortest text reaching it, e.g. 'one_hundred_and' for 'one hundred and'
+// The translator tests check that the machine and the parser agree on every sequence of number words up to a given length
+namespace number_expression_machine {
+
+enum class state_t : uint8_t {
+    start,
+    complete,
+    one,
+    ten,
+    twenty,
+    one_hundred,
+    one_thousand,
+    one_million,
+    one_billion,
+    ten_hundred,
+    twenty_dash,
+    one_hundred_and,
+    one_thousand_one,
+    one_thousand_and,
+    one_million_one,
+    one_million_ten,
+    one_million_twenty,
+    one_million_and,
+    one_billion_one,
+    one_billion_ten,
+    one_billion_twenty,
+    one_billion_and,
+    one_hundred_and_twenty,
+    one_thousand_and_twenty,
+    one_million_one_hundred,
+    one_million_twenty_dash,
+    one_million_and_twenty,
+    one_billion_one_hundred,
+    one_billion_twenty_dash,
+    one_billion_and_twenty,
+    one_hundred_and_twenty_dash,
+    one_thousand_and_twenty_dash,
+    one_million_one_hundred_and,
+    one_million_and_twenty_dash,
+    one_billion_one_hundred_and,
+    one_billion_and_twenty_dash,
+    one_million_one_hundred_and_twenty,
+    one_billion_one_hundred_and_twenty,
+    one_million_one_hundred_and_twenty_dash,
+    one_billion_one_hundred_and_twenty_dash,
+    accept,
+    reject
+};
+
+inline constexpr size_t state_count{ static_cast<size_t>(state_t::accept) };
+inline constexpr size_t lexeme_count{ static_cast<size_t>(lexeme_t::end) + 1 };
+
+using row_t = std::array<state_t, lexeme_count>;
+using table_t = std::array<row_t, state_count>;
+
+
+namespace detail {
+
+struct transition_t {
+    lexeme_t lexeme{};
+    state_t next{};
+};
+
+// Transitions leaving a state
+// Lexemes without a transition end the expression, either accepting or rejecting it
+struct state_transitions_t {
+    state_t state{};
+    state_t otherwise{};
+    std::initializer_list<transition_t> transitions{};
+};
+
+[[nodiscard]] consteval table_t make_table(std::initializer_list<state_transitions_t> states) {
+    table_t ret{};
+    std::array<bool, state_count> defined{};
+    for (const auto& [state, otherwise, transitions] : states) {
+        auto& row{ ret[static_cast<size_t>(state)] };
+        row.fill(otherwise);
+        for (const auto& [lexeme, next] : transitions) {
+            row[static_cast<size_t>(lexeme)] = next;
+        }
+        if (defined[static_cast<size_t>(state)]) {
+            throw "state defined twice";
+        }
+        defined[static_cast<size_t>(state)] = true;
+    }
+    for (auto d : defined) {
+        if (not d) {
+            throw "state not defined";
+        }
+    }
+    return ret;
+}
+
+}  // namespace detail
+
+
+inline constexpr table_t table{
+    [] {
+        using enum state_t;
+        using l = lexeme_t;
+        return detail::make_table({
+            { start, reject, {
+                { l::zero, complete }, { l::one, one }, { l::two_to_nine, one },
+                { l::ten_to_nineteen, ten }, { l::tens, twenty }
+            } },
+            { complete, accept, {} },
+            { one, accept, {
+                { l::hundred, one_hundred }, { l::thousand, one_thousand }, { l::million, one_million },
+                { l::billion, one_billion }
+            } },
+            { ten, accept, {
+                { l::hundred, ten_hundred }, { l::thousand, one_thousand }, { l::million, one_million },
+                { l::billion, one_billion }
+            } },
+            { twenty, accept, {
+                { l::one, ten }, { l::two_to_nine, ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }, { l::million, one_million }, { l::billion, one_billion },
+                { l::dash, twenty_dash }
+            } },
+            { one_hundred, accept, {
+                { l::hundred, ten_hundred }, { l::thousand, one_thousand }, { l::million, one_million },
+                { l::billion, one_billion }, { l::and_connector, one_hundred_and }
+            } },
+            { one_thousand, accept, {
+                { l::one, one_thousand_one }, { l::two_to_nine, one_thousand_one }, { l::and_connector, one_thousand_and }
+            } },
+            { one_million, accept, {
+                { l::one, one_million_one }, { l::two_to_nine, one_million_one }, { l::ten_to_nineteen, one_million_ten },
+                { l::tens, one_million_twenty }, { l::and_connector, one_million_and }
+            } },
+            { one_billion, accept, {
+                { l::one, one_billion_one }, { l::two_to_nine, one_billion_one }, { l::ten_to_nineteen, one_billion_ten },
+                { l::tens, one_billion_twenty }, { l::and_connector, one_billion_and }
+            } },
+            { ten_hundred, accept, {
+                { l::and_connector, one_thousand_and }
+            } },
+            { twenty_dash, reject, {
+                { l::one, ten }, { l::two_to_nine, ten }, { l::ten_to_nineteen, ten }
+            } },
+            { one_hundred_and, accept, {
+                { l::one, ten }, { l::two_to_nine, ten }, { l::ten_to_nineteen, ten },
+                { l::tens, one_hundred_and_twenty }, { l::hundred, ten_hundred }, { l::thousand, one_thousand },
+                { l::million, one_million }, { l::billion, one_billion }
+            } },
+            { one_thousand_one, accept, {
+                { l::hundred, ten_hundred }
+            } },
+            { one_thousand_and, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }, { l::ten_to_nineteen, complete },
+                { l::tens, one_thousand_and_twenty }
+            } },
+            { one_million_one, accept, {
+                { l::hundred, one_million_one_hundred }, { l::thousand, one_thousand }
+            } },
+            { one_million_ten, accept, {
+                { l::hundred, ten_hundred }, { l::thousand, one_thousand }
+            } },
+            { one_million_twenty, accept, {
+                { l::one, one_million_ten }, { l::two_to_nine, one_million_ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }, { l::dash, one_million_twenty_dash }
+            } },
+            { one_million_and, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }, { l::ten_to_nineteen, complete },
+                { l::tens, one_million_and_twenty }
+            } },
+            { one_billion_one, accept, {
+                { l::hundred, one_billion_one_hundred }, { l::thousand, one_thousand }, { l::million, one_million }
+            } },
+            { one_billion_ten, accept, {
+                { l::hundred, ten_hundred }, { l::thousand, one_thousand }, { l::million, one_million }
+            } },
+            { one_billion_twenty, accept, {
+                { l::one, one_billion_ten }, { l::two_to_nine, one_billion_ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }, { l::million, one_million }, { l::dash, one_billion_twenty_dash }
+            } },
+            { one_billion_and, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }, { l::ten_to_nineteen, complete },
+                { l::tens, one_billion_and_twenty }
+            } },
+            { one_hundred_and_twenty, accept, {
+                { l::one, ten }, { l::two_to_nine, ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }, { l::million, one_million }, { l::billion, one_billion },
+                { l::dash, one_hundred_and_twenty_dash }
+            } },
+            { one_thousand_and_twenty, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }, { l::dash, one_thousand_and_twenty_dash }
+            } },
+            { one_million_one_hundred, accept, {
+                { l::hundred, ten_hundred }, { l::thousand, one_thousand }, { l::and_connector, one_million_one_hundred_and }
+            } },
+            { one_million_twenty_dash, accept, {
+                { l::one, one_million_ten }, { l::two_to_nine, one_million_ten }, { l::ten_to_nineteen, one_million_ten }
+            } },
+            { one_million_and_twenty, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }, { l::dash, one_million_and_twenty_dash }
+            } },
+            { one_billion_one_hundred, accept, {
+                { l::hundred, ten_hundred }, { l::thousand, one_thousand }, { l::million, one_million },
+                { l::and_connector, one_billion_one_hundred_and }
+            } },
+            { one_billion_twenty_dash, accept, {
+                { l::one, one_billion_ten }, { l::two_to_nine, one_billion_ten }, { l::ten_to_nineteen, one_billion_ten }
+            } },
+            { one_billion_and_twenty, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }, { l::dash, one_billion_and_twenty_dash }
+            } },
+            { one_hundred_and_twenty_dash, accept, {
+                { l::one, ten }, { l::two_to_nine, ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }, { l::million, one_million }, { l::billion, one_billion }
+            } },
+            { one_thousand_and_twenty_dash, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }
+            } },
+            { one_million_one_hundred_and, accept, {
+                { l::one, one_million_ten }, { l::two_to_nine, one_million_ten }, { l::ten_to_nineteen, one_million_ten },
+                { l::tens, one_million_one_hundred_and_twenty }, { l::hundred, ten_hundred }, { l::thousand, one_thousand }
+            } },
+            { one_million_and_twenty_dash, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }, { l::ten_to_nineteen, one_million_ten },
+                { l::tens, one_million_twenty }
+            } },
+            { one_billion_one_hundred_and, accept, {
+                { l::one, one_billion_ten }, { l::two_to_nine, one_billion_ten }, { l::ten_to_nineteen, one_billion_ten },
+                { l::tens, one_billion_one_hundred_and_twenty }, { l::hundred, ten_hundred }, { l::thousand, one_thousand },
+                { l::million, one_million }
+            } },
+            { one_billion_and_twenty_dash, accept, {
+                { l::one, complete }, { l::two_to_nine, complete }, { l::ten_to_nineteen, one_billion_ten },
+                { l::tens, one_billion_twenty }
+            } },
+            { one_million_one_hundred_and_twenty, accept, {
+                { l::one, one_million_ten }, { l::two_to_nine, one_million_ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }, { l::dash, one_million_one_hundred_and_twenty_dash }
+            } },
+            { one_billion_one_hundred_and_twenty, accept, {
+                { l::one, one_billion_ten }, { l::two_to_nine, one_billion_ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }, { l::million, one_million }, { l::dash, one_billion_one_hundred_and_twenty_dash }
+            } },
+            { one_million_one_hundred_and_twenty_dash, accept, {
+                { l::one, one_million_ten }, { l::two_to_nine, one_million_ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }
+            } },
+            { one_billion_one_hundred_and_twenty_dash, accept, {
+                { l::one, one_billion_ten }, { l::two_to_nine, one_billion_ten }, { l::hundred, ten_hundred },
+                { l::thousand, one_thousand }, { l::million, one_million }
+            } }
+        });
+    }()
+};
+
+
+[[nodiscard]] constexpr state_t next(state_t state, lexeme_t lexeme) {
+    return table[static_cast<size_t>(state)][static_cast<size_t>(lexeme)];
+}
+
+[[nodiscard]] constexpr bool is_final(state_t state) {
+    return state == state_t::accept or state == state_t::reject;
+}
+
+// Whether a sequence of lexemes, followed by the end of the text, makes a whole number expression
+[[nodiscard]] constexpr bool accepts(std::initializer_list<lexeme_t> lexemes) {
+    auto state{ state_t::start };
+    for (auto lexeme : lexemes) {
+        state = next(state, lexeme);
+        if (is_final(state)) {
+            return false;
+        }
+    }
+    return next(state, lexeme_t::end) == state_t::accept;
+}
+
+
+namespace detail {
+
+using enum lexeme_t;
+
+static_assert(accepts({ zero }));
+static_assert(accepts({ tens, dash, one }));
+static_assert(accepts({ tens, one }));
+static_assert(accepts({ one, thousand, and_connector, two_to_nine }));
+static_assert(accepts({
+    two_to_nine, hundred, and_connector, tens, dash, two_to_nine, billion,
+    two_to_nine, hundred, and_connector, tens, dash, two_to_nine, million,
+    two_to_nine, hundred, and_connector, tens, dash, two_to_nine, thousand,
+    two_to_nine, hundred, and_connector, tens, dash, two_to_nine }));
+static_assert(not accepts({ one, two_to_nine }));
+static_assert(not accepts({ tens, dash }));
+static_assert(not accepts({ hundred }));
+static_assert(not accepts({ and_connector }));
+
+}  // namespace detail
+
+}  // namespace number_expression_machine
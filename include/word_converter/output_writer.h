@@ -1,9 +1,31 @@
 #pragma once
 
+#include "file_descriptor.h"
+#include "io_ring.h"
+
+#include <algorithm>  // max, min
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>  // uint64_t
+#include <cstring>  // memcpy
 #include <filesystem>
 #include <fmt/format.h>
 #include <fstream>
+#include <memory>  // unique_ptr
+#include <optional>
 #include <stdexcept>  // runtime_error
+#include <string>
+#include <string_view>
+#include <system_error>  // system_category
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>  // fcntl, open, splice
+#include <sys/stat.h>  // fstat
+#include <sys/uio.h>  // writev
+#include <unistd.h>  // copy_file_range, lseek
+#endif
 
 namespace fs = std::filesystem;
 
@@ -18,19 +40,86 @@ private:
 };
 
 
+struct output_error : public std::runtime_error {
+    output_error(const std::string& operation, int error) : std::runtime_error{ "" } {
+        message_ += fmt::format("'{}': {}", operation, std::system_category().message(error));
+    }
+    [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
+private:
+    std::string message_{ "output error: " };
+};
+
+
+// When a writer flushes its output
+// Output is flushed once a number of bytes are pending, or once some time has passed since the last flush
+// Thresholds are checked after every write, and a policy without thresholds flushes every write, e.g. every sentence
+struct flush_policy {
+    std::optional<size_t> bytes{};
+    std::optional<std::chrono::milliseconds> interval{};
+
+    [[nodiscard]] bool operator==(const flush_policy& other) const = default;
+};
+
+
 class output_writer {
-    [[nodiscard]] virtual std::ostream& get_ostream() = 0;
+    using clock_t = std::chrono::steady_clock;
+
+    std::optional<flush_policy> flush_policy_{};
+    size_t pending_bytes_{ 0 };
+    clock_t::time_point last_flush_{};
+
+    virtual void put(std::string_view text) = 0;
+    virtual void flush_sinks() = 0;
 public:
     virtual ~output_writer() = default;
 
-    void write(const std::string& text) {
-        auto& os{ get_ostream() };
-        os << text;
+    // Writers without a flush policy leave flushing to their stream, or to their buffer
+    void set_flush_policy(const flush_policy& policy) {
+        flush_policy_ = policy;
+        last_flush_ = clock_t::now();
+    }
+    void write(std::string_view text) {
+        put(text);
+        if (not flush_policy_) {
+            return;
+        }
+        pending_bytes_ += text.size();
+        const auto& [bytes, interval] { *flush_policy_ };
+        auto now{ interval ? clock_t::now() : clock_t::time_point{} };
+        if ((not bytes and not interval) or
+            (bytes and pending_bytes_ >= *bytes) or
+            (interval and now - last_flush_ >= *interval)) {
+            flush_sinks();
+            pending_bytes_ = 0;
+            last_flush_ = now;
+        }
+    }
+    // Writes out any pending text, e.g. once the whole output has been written
+    void flush() {
+        flush_sinks();
+        pending_bytes_ = 0;
+    }
+    // Output writers can be used as text sinks
+    void append(std::string_view text) {
+        write(text);
     }
 };
 
 
-class file_writer : public output_writer {
+// Writer to an output stream, which buffers the text
+class ostream_writer : public output_writer {
+    [[nodiscard]] virtual std::ostream& get_ostream() = 0;
+
+    void put(std::string_view text) override {
+        get_ostream() << text;
+    }
+    void flush_sinks() override {
+        get_ostream().flush();
+    }
+};
+
+
+class file_writer : public ostream_writer {
 public:
     explicit file_writer(const fs::path& file_path) : ofs_{ file_path } {
         if (not ofs_) {
@@ -46,7 +135,7 @@ private:
 };
 
 
-class stream_writer : public output_writer {
+class stream_writer : public ostream_writer {
 public:
     explicit stream_writer(std::ostream& os) : os_{ os } {}
 private:
@@ -58,4 +147,277 @@ private:
 };
 
 
+#ifndef _WIN32
+// Writer to one or more file descriptors, e.g. the standard output and an output file
+// Text is gathered in a user-space buffer, and only written out in whole blocks, when the buffer is full or flushed
+// A block is written to the first sink with a single writev: a text that does not fit in the buffer is not copied into it,
+// but written together with the buffered text
+// The other sinks duplicate the first one: if it is a regular file opened for reading and writing, e.g. an output file
+// created by the writer, the block is copied from it by the kernel, with copy_file_range into regular files,
+// and splice into pipes, so it does not go through user space again
+// Sinks the kernel cannot copy into, e.g. terminals, or files on another file system on old kernels, are written with writev
+class multi_sink_writer : public output_writer {
+public:
+    static constexpr size_t default_buffer_size{ size_t{ 1024 } * 1024 };
+private:
+    using blocks_t = std::array<std::string_view, 2>;
+
+    struct sink {
+        int fd{ -1 };
+        file_descriptor owned_fd{};  // set if the sink was created by the writer
+        bool is_regular_file{ false };
+        bool is_pipe{ false };
+        bool is_readable{ false };  // i.e. opened for reading and writing, so the other sinks can be copied from it
+        bool is_duplicable{ false };  // i.e. the kernel has not refused to copy into it yet
+        uint64_t copied{ 0 };  // bytes copied into it by the kernel
+    };
+
+    // A readable regular file, if any, goes first, so that the other sinks can be copied from it
+    std::vector<sink> sinks_{};
+    std::string buffer_{};
+    size_t buffer_size_{};
+private:
+    static void remove_prefix(blocks_t& blocks, size_t size) {
+        for (auto& block : blocks) {
+            auto n{ std::min(size, block.size()) };
+            block.remove_prefix(n);
+            size -= n;
+        }
+    }
+    static void write_all(int fd, blocks_t blocks, size_t offset) {
+        remove_prefix(blocks, offset);
+        while (not blocks[0].empty() or not blocks[1].empty()) {
+            std::array<iovec, 2> iov{ {
+                { const_cast<char*>(blocks[0].data()), blocks[0].size() },
+                { const_cast<char*>(blocks[1].data()), blocks[1].size() }
+            } };
+            auto n{ ::writev(fd, iov.data(), static_cast<int>(iov.size())) };
+            if (n == -1 and errno == EINTR) {
+                continue;
+            }
+            if (n == -1) {
+                throw output_error{ "writev", errno };
+            }
+            remove_prefix(blocks, static_cast<size_t>(n));
+        }
+    }
+    // Copies size bytes of the first sink, starting at offset, into another sink
+    // Returns the number of bytes copied, which is less than size if the kernel refused to copy them
+    [[nodiscard]] static size_t duplicate(int from, off_t offset, sink& to, size_t size) {
+        size_t copied{ 0 };
+#ifdef __linux__
+        while (copied < size and to.is_duplicable) {
+            auto n{ to.is_regular_file
+                ? ::copy_file_range(from, &offset, to.fd, nullptr, size - copied, 0)
+                : ::splice(from, &offset, to.fd, nullptr, size - copied, 0) };
+            if (n == -1 and errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                to.is_duplicable = false;
+                break;
+            }
+            copied += static_cast<size_t>(n);
+        }
+        to.copied += copied;
+#else
+        (void) from; (void) offset; (void) to; (void) size;
+#endif
+        return copied;
+    }
+    void write_out(const blocks_t& blocks) {
+        auto size{ blocks[0].size() + blocks[1].size() };
+        if (size == 0 or sinks_.empty()) {
+            return;
+        }
+        auto& first{ sinks_.front() };
+        write_all(first.fd, blocks, 0);
+        // The offset of the first sink is asked for, instead of being kept, because its file may have been opened for appending
+        off_t end{ (first.is_regular_file and first.is_readable) ? ::lseek(first.fd, 0, SEEK_CUR) : off_t{ -1 } };
+        for (size_t i{ 1 }; i < sinks_.size(); ++i) {
+            auto& s{ sinks_[i] };
+            size_t copied{ 0 };
+            if (end >= static_cast<off_t>(size)) {
+                copied = duplicate(first.fd, end - static_cast<off_t>(size), s, size);
+            }
+            write_all(s.fd, blocks, copied);
+        }
+    }
+
+    void put(std::string_view text) override {
+        if (buffer_.size() + text.size() <= buffer_size_) {
+            buffer_.append(text);
+            return;
+        }
+        write_out({ buffer_, text });
+        buffer_.clear();
+    }
+    void flush_sinks() override {
+        write_out({ buffer_, {} });
+        buffer_.clear();
+    }
+    void add_sink(sink s) {
+        struct stat st{};
+        if (::fstat(s.fd, &st) == -1) {
+            throw output_error{ "fstat", errno };
+        }
+        s.is_regular_file = S_ISREG(st.st_mode);
+        s.is_pipe = S_ISFIFO(st.st_mode);
+        s.is_readable = ((::fcntl(s.fd, F_GETFL) & O_ACCMODE) == O_RDWR);
+        s.is_duplicable = (s.is_regular_file or s.is_pipe);
+        auto is_source = [](const sink& t) { return t.is_regular_file and t.is_readable; };
+        if (is_source(s) and not sinks_.empty() and not is_source(sinks_.front())) {
+            sinks_.insert(sinks_.begin(), std::move(s));
+        } else {
+            sinks_.push_back(std::move(s));
+        }
+    }
+public:
+    explicit multi_sink_writer(size_t buffer_size = default_buffer_size) : buffer_size_{ buffer_size } {
+        buffer_.reserve(buffer_size_);
+    }
+    multi_sink_writer(const multi_sink_writer&) = delete;
+    multi_sink_writer& operator=(const multi_sink_writer&) = delete;
+    // Pending text is written out, but errors are lost, so flush should be called before
+    ~multi_sink_writer() override {
+        try {
+            flush_sinks();
+        } catch (...) {}
+    }
+
+    // A file descriptor is not owned by the writer, e.g. that of the standard output
+    void add_sink(int fd) {
+        add_sink(sink{ .fd = fd });
+    }
+    // A file is created, or truncated, and owned by the writer
+    // It is opened for reading too, so that the other sinks can be copied from it
+    void add_sink(const fs::path& file_path) {
+        file_descriptor fd{ ::open(file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666) };
+        if (fd.get() == -1) {
+            throw could_not_create_file_error{ file_path };
+        }
+        auto raw_fd{ fd.get() };
+        add_sink(sink{ .fd = raw_fd, .owned_fd = std::move(fd) });
+    }
+
+    // Bytes copied by the kernel from the first sink into the others, instead of being written to them
+    [[nodiscard]] uint64_t get_copied_bytes() const {
+        uint64_t ret{};
+        for (const auto& s : sinks_) {
+            ret += s.copied;
+        }
+        return ret;
+    }
+};
+
+// Writer to a file, keeping several large writes in flight on an io_ring
+// Text is gathered into a ring of buffers: once a buffer is full, it is written at its offset in the file,
+// and the next buffer is filled meanwhile, once its previous write, if any, has completed
+// A flush waits for every write to complete
+class async_file_writer : public output_writer {
+public:
+    static constexpr size_t default_block_size{ size_t{ 1024 } * 1024 };
+    static constexpr size_t default_blocks{ 4 };
+private:
+    struct block {
+        std::vector<char> data{};
+        size_t size{};  // gathered, or being written
+        uint64_t offset{};  // in the file
+        size_t written{};
+        bool in_flight{};
+    };
+
+    file_descriptor fd_{};
+    uint64_t offset_{};  // of the next block to be written
+    std::vector<block> blocks_{};
+    size_t current_{};  // block being filled
+    io_ring ring_;
+private:
+    void write_block() {
+        auto& b{ blocks_[current_] };
+        b.offset = offset_;
+        b.written = 0;
+        b.in_flight = true;
+        offset_ += b.size;
+        ring_.write(fd_.get(), b.data.data(), b.size, b.offset, current_);
+        ring_.submit();
+        current_ = (current_ + 1) % blocks_.size();
+    }
+    // A short write asks for the rest of its block
+    void complete(const io_completion& completion) {
+        auto& b{ blocks_[completion.user_data] };
+        if (completion.result <= 0) {
+            b.in_flight = false;
+            b.size = 0;
+            throw output_error{ "write", completion.result < 0 ? -completion.result : EIO };
+        }
+        b.written += static_cast<size_t>(completion.result);
+        if (b.written < b.size) {
+            ring_.write(fd_.get(), b.data.data() + b.written, b.size - b.written, b.offset + b.written, completion.user_data);
+            ring_.submit();
+        } else {
+            b.in_flight = false;
+            b.size = 0;
+        }
+    }
+
+    void put(std::string_view text) override {
+        while (not text.empty()) {
+            auto& b{ blocks_[current_] };
+            while (b.in_flight) {
+                complete(ring_.wait());
+            }
+            auto n{ std::min(text.size(), b.data.size() - b.size) };
+            std::memcpy(b.data.data() + b.size, text.data(), n);
+            b.size += n;
+            text.remove_prefix(n);
+            if (b.size == b.data.size()) {
+                write_block();
+            }
+        }
+    }
+    void flush_sinks() override {
+        if (auto& b{ blocks_[current_] }; not b.in_flight and b.size > 0) {
+            write_block();
+        }
+        while (ring_.in_flight() > 0) {
+            complete(ring_.wait());
+        }
+    }
+public:
+    // A file is created, or truncated
+    // Falls back to synchronous writes, one block at a time, if the backend is not available
+    explicit async_file_writer(const fs::path& file_path, io_backend backend = io_backend::io_uring,
+        size_t block_size = default_block_size, size_t blocks = default_blocks)
+        : ring_{ static_cast<unsigned>(std::max<size_t>(blocks, 1)), backend } {
+
+        fd_ = file_descriptor{ ::open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666) };
+        if (fd_.get() == -1) {
+            throw could_not_create_file_error{ file_path };
+        }
+        blocks_.resize(std::max<size_t>(blocks, 1));
+        for (auto& b : blocks_) {
+            b.data.resize(std::max<size_t>(block_size, 1));
+        }
+    }
+    async_file_writer(const async_file_writer&) = delete;
+    async_file_writer& operator=(const async_file_writer&) = delete;
+    // Pending text is written out, but errors are lost, so flush should be called before
+    // Writes still in flight are waited for, so that the kernel does not read from freed buffers
+    ~async_file_writer() override {
+        try {
+            flush_sinks();
+        } catch (...) {}
+        try {
+            while (ring_.in_flight() > 0) {
+                (void) ring_.wait();
+            }
+        } catch (...) {}
+    }
+
+    [[nodiscard]] bool is_async() const { return ring_.is_async(); }
+};
+#endif  // _WIN32
+
+
 using output_writer_up = std::unique_ptr<output_writer>;
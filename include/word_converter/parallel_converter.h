@@ -0,0 +1,192 @@
+#pragma once
+
+#include "conversion_stats.h"  // thread_cpu_time
+#include "input_reader.h"
+#include "trace.h"
+#include "translator.h"
+
+#include <algorithm>  // clamp, max
+#include <chrono>
+#include <concepts>  // invocable
+#include <condition_variable>
+#include <cstring>  // memchr
+#include <exception>  // exception_ptr, rethrow_exception
+#include <memory>  // make_unique
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>  // jthread
+#include <vector>
+
+
+// Splits a text into chunks of about chunk_size bytes
+// Every chunk but the last one ends right after a period
+[[nodiscard]] inline std::vector<std::string_view> split_into_chunks(std::string_view text, size_t chunk_size) {
+    std::vector<std::string_view> ret{};
+    chunk_size = std::max(chunk_size, size_t{ 1 });
+    while (not text.empty()) {
+        auto size{ text.size() };
+        if (chunk_size < text.size()) {
+            auto from{ text.data() + chunk_size - 1 };
+            if (auto period{ static_cast<const char*>(std::memchr(from, '.', text.size() - chunk_size + 1)) }) {
+                size = static_cast<size_t>(period - text.data()) + 1;
+            }
+        }
+        ret.push_back(text.substr(0, size));
+        text.remove_prefix(size);
+    }
+    return ret;
+}
+
+
+// Converts a text in chunks, on a pool of worker threads
+// Sentences don't share any state, so every chunk is converted by its own translator
+// Chunks are handed over to the callback in order, so the output is the same as that of a serial conversion
+// Workers only run a few chunks ahead of the callback, which bounds the memory used by converted chunks
+class parallel_converter {
+    size_t jobs_{};
+    size_t chunk_size_{};
+
+    // Of the last conversion
+    translation_counters counters_{};
+    std::chrono::nanoseconds cpu_time_{};  // of all the workers
+private:
+    struct chunk_result {
+        std::string text{};
+        translation_counters counters{};
+        std::vector<sentence_error> sentence_errors{};  // only in recovery mode, with offsets relative to the chunk
+        std::exception_ptr error{};
+        bool done{};
+    };
+
+    // Offsets in the trace are relative to the chunk, and the chunk span has the offset of the chunk in the whole text
+    [[nodiscard]] static chunk_result convert_chunk(std::string_view chunk, [[maybe_unused]] size_t offset, bool recover) {
+        WORD_CONVERTER_TRACE_SPAN("chunk", offset);
+        chunk_result ret{};
+        try {
+            translator t{ std::make_unique<memory_reader>(chunk) };
+            auto on_sentence = [&ret](const std::string& sentence) { ret.text += sentence; };
+            if (recover) {
+                t.translate(on_sentence, [&ret](const sentence_error& error) { ret.sentence_errors.push_back(error); });
+            } else {
+                t.translate(on_sentence);
+            }
+            ret.counters = t.get_counters();
+        } catch (...) {
+            ret.error = std::current_exception();
+        }
+        ret.done = true;
+        return ret;
+    }
+
+    void convert_chunks(std::string_view text, std::invocable<const std::string&> auto& on_chunk,
+        std::invocable<const sentence_error&> auto& on_error, bool recover) {
+        auto chunk_size{ chunk_size_ != 0
+            ? chunk_size_
+            : std::clamp(text.size() / (jobs_ * 4), min_chunk_size, max_chunk_size) };
+        auto chunks{ split_into_chunks(text, chunk_size) };
+        std::vector<chunk_result> results(chunks.size());
+        const size_t max_chunks_in_flight{ jobs_ * 2 };
+
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        size_t next_chunk{ 0 };
+        size_t emitted_chunks{ 0 };
+        bool stop{ false };
+        counters_ = {};
+        cpu_time_ = {};
+
+        auto worker = [&]() {
+            while (true) {
+                size_t i{};
+                {
+                    std::unique_lock lock{ mutex };
+                    cv.wait(lock, [&]() {
+                        return stop or next_chunk == chunks.size() or next_chunk < emitted_chunks + max_chunks_in_flight;
+                    });
+                    if (stop or next_chunk == chunks.size()) {
+                        return;
+                    }
+                    i = next_chunk++;
+                }
+                auto result{ convert_chunk(chunks[i], static_cast<size_t>(chunks[i].data() - text.data()), recover) };
+                {
+                    std::lock_guard lock{ mutex };
+                    results[i] = std::move(result);
+                }
+                cv.notify_all();
+            }
+        };
+
+        std::exception_ptr error{};
+        {
+            std::vector<std::jthread> workers{};
+            for (size_t j{ 0 }; j < std::min(jobs_, chunks.size()); ++j) {
+                workers.emplace_back([&]() {
+                    WORD_CONVERTER_TRACE_THREAD("worker");
+                    auto start{ thread_cpu_time() };
+                    worker();
+                    std::lock_guard lock{ mutex };
+                    cpu_time_ += thread_cpu_time() - start;
+                });
+            }
+            for (size_t i{ 0 }; i < chunks.size() and not error; ++i) {
+                chunk_result result{};
+                {
+                    std::unique_lock lock{ mutex };
+                    cv.wait(lock, [&]() { return results[i].done; });
+                    result = std::move(results[i]);
+                }
+                // A failed chunk still hands over the sentences converted before the error
+                // The errors a chunk recovered from are handed over before its text, with offsets relative to the whole text
+                try {
+                    for (auto& recovered : result.sentence_errors) {
+                        recovered.offset += static_cast<size_t>(chunks[i].data() - text.data());
+                        on_error(recovered);
+                    }
+                    on_chunk(result.text);
+                    counters_ += result.counters;
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                if (not error) {
+                    error = result.error;
+                }
+                {
+                    std::lock_guard lock{ mutex };
+                    ++emitted_chunks;
+                    stop = (error != nullptr);
+                }
+                cv.notify_all();
+            }
+        }  // join workers
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+public:
+    static constexpr size_t min_chunk_size{ 64 * 1024 };
+    static constexpr size_t max_chunk_size{ 16 * 1024 * 1024 };
+
+    // A chunk size of 0 lets the converter choose one depending on the size of the text
+    explicit parallel_converter(size_t jobs, size_t chunk_size = 0)
+        : jobs_{ std::max(jobs, size_t{ 1 }) }
+        , chunk_size_{ chunk_size }
+    {}
+
+    void convert(std::string_view text, std::invocable<const std::string&> auto&& on_chunk) {
+        auto on_error = [](const sentence_error&) {};
+        convert_chunks(text, on_chunk, on_error, false);
+    }
+    // Recovery mode, see translator
+    // Malformed sentences are reported in input order, each one before the chunk holding it is handed over
+    void convert(std::string_view text, std::invocable<const std::string&> auto&& on_chunk,
+        std::invocable<const sentence_error&> auto&& on_error) {
+        convert_chunks(text, on_chunk, on_error, true);
+    }
+
+    // Of the chunks handed over by the last conversion
+    [[nodiscard]] translation_counters get_counters() const { return counters_; }
+    // Spent by the workers of the last conversion, which does not include handing chunks over
+    [[nodiscard]] std::chrono::nanoseconds get_cpu_time() const { return cpu_time_; }
+};
@@ -4,54 +4,22 @@
 #include "input_reader.h"
 #include "lexer.h"
 
+#include <concepts>  // invocable
 #include <fmt/core.h>
-#include <memory>  // make_unique, unique_ptr
+#include <cstddef>  // byte
+#include <memory>  // make_unique, make_unique_for_overwrite, unique_ptr
+#include <memory_resource>  // monotonic_buffer_resource
 #include <ranges>
-#include <rtc/string.h>
 #include <stdexcept>  // runtime_error
 #include <string>
-#include <unordered_map>
-
-
-inline static const std::unordered_map<std::string, int> word_to_number_map{
-    { "zero", 0 },  // zero
-    { "one", 1 },  // one
-    { "two", 2 },  // two to nine
-    { "three", 3 },
-    { "four", 4 },
-    { "five", 5 },
-    { "six", 6 },
-    { "seven", 7 },
-    { "eight", 8 },
-    { "nine", 9 },
-    { "ten", 10 },  // ten to nineteen
-    { "eleven", 11 },
-    { "twelve", 12 },
-    { "thirteen", 13 },
-    { "fourteen", 14 },
-    { "fifteen", 15 },
-    { "sixteen", 16 },
-    { "seventeen", 17 },
-    { "eighteen", 18 },
-    { "nineteen", 19 },
-    { "twenty", 20 },  // tens
-    { "thirty", 30 },
-    { "forty", 40 },
-    { "fifty", 50 },
-    { "sixty", 60 },
-    { "seventy", 70 },
-    { "eighty", 80 },
-    { "ninety", 90 },
-    { "hundred", 100 },  // a hundred
-    { "thousand", 1'000 },  // a thousand
-    { "million", 1'000'000 },  // a million
-    { "billion", 1'000'000'000 }  // a billion
-};
 
 
 struct invalid_token_error : public std::runtime_error {
-    invalid_token_error(const token_t& token, const std::string& node_str) : std::runtime_error{ "" } {
-        message_ = fmt::format("invalid token: '{}', while parsing node: '{}'", token, node_str);
+    invalid_token_error(const token_t& token, const std::string& node_str) : invalid_token_error{ make_message(token, node_str) } {}
+    // E.g. from the message of an error that was returned instead of thrown
+    explicit invalid_token_error(std::string message) : std::runtime_error{ "" }, message_{ std::move(message) } {}
+    [[nodiscard]] static std::string make_message(const token_t& token, const std::string& node_str) {
+        return fmt::format("invalid token: '{}', while parsing node: '{}'", token, node_str);
     }
     [[nodiscard]] const char* what() const noexcept override { return message_.c_str(); };
 private:
@@ -62,11 +30,18 @@ private:
 class parser {
     std::unique_ptr<lexer> lexer_{};
     std::unique_ptr<ast::tree> ast_{};
+
+    // Arena for the nodes of a sentence, released after each sentence is evaluated, in a streaming parse
+    // Sentences not fitting in the arena buffer take the rest of their memory from the default resource
+    static constexpr size_t arena_buffer_size{ 64 * 1024 };
+    std::unique_ptr<std::byte[]> arena_buffer_{ std::make_unique_for_overwrite<std::byte[]>(arena_buffer_size) };
+    std::pmr::monotonic_buffer_resource arena_{ arena_buffer_.get(), arena_buffer_size };
+    std::string sentence_output_{};
 private:
     void advance_to_next_token(auto& node) {
         lexer_->advance_to_next_token();
         if (lexer_->get_current_lexeme() == lexeme_t::space) {
-            node.add(ast::text_node{ lexer_->get_current_text() });
+            node.add(ast::text_node{ lexer_->get_current_text(), node.get_allocator() });
             lexer_->advance_to_next_token();
         }
     }
@@ -76,7 +51,7 @@ private:
     }
     [[nodiscard]] bool space(auto& node) {
         if (lexer_->get_current_lexeme() == lexeme_t::space) {
-            node.add(ast::text_node{ lexer_->get_current_text() });
+            node.add(ast::text_node{ lexer_->get_current_text(), node.get_allocator() });
             advance_to_next_token(node);
             return true;
         }
@@ -84,7 +59,7 @@ private:
     }
     [[nodiscard]] bool dash(auto& node) {
         if (lexer_->get_current_lexeme() == lexeme_t::dash) {
-            node.add(ast::text_node{ lexer_->get_current_text() });
+            node.add(ast::text_node{ lexer_->get_current_text(), node.get_allocator() });
             advance_to_next_token(node);
             return true;
         }
@@ -92,7 +67,7 @@ private:
     }
     [[nodiscard]] bool period(auto& node) {
         if (lexer_->get_current_lexeme() == lexeme_t::period) {
-            node.add(ast::text_node{ lexer_->get_current_text() });
+            node.add(ast::text_node{ lexer_->get_current_text(), node.get_allocator() });
             advance_to_next_token(node);
             return true;
         }
@@ -100,7 +75,7 @@ private:
     }
     [[nodiscard]] bool and_connector(auto& node) {
         if (lexer_->get_current_lexeme() == lexeme_t::and_connector) {
-            node.add(ast::text_node{ lexer_->get_current_text() });
+            node.add(ast::text_node{ lexer_->get_current_text(), node.get_allocator() });
             advance_to_next_token(node);
             return true;
         }
@@ -108,7 +83,7 @@ private:
     }
     [[nodiscard]] bool other(auto& node) {
         if (lexer_->get_current_lexeme() == lexeme_t::other) {
-            node.add(ast::text_node{ lexer_->get_current_text() });
+            node.add(ast::text_node{ lexer_->get_current_text(), node.get_allocator() });
             advance_to_next_token(node);
             return true;
         }
@@ -132,9 +107,7 @@ private:
     }
     [[nodiscard]] bool two_to_nine(auto& node) {
         if (lexer_->get_current_lexeme() == lexeme_t::two_to_nine) {
-            auto word_lc{ rtc::string::to_lowercase(lexer_->get_current_text()) };
-            auto one_to_nine_number{ word_to_number_map.at(word_lc) };
-            node.add(ast::int_node{ one_to_nine_number });
+            node.add(ast::int_node{ lexer_->get_current_token().value });
             advance_to_next_token(node);
             return true;
         }
@@ -145,9 +118,7 @@ private:
     }
     [[nodiscard]] bool ten_to_nineteen(auto& node) {
         if (lexer_->get_current_lexeme() == lexeme_t::ten_to_nineteen) {
-            auto word_lc{ rtc::string::to_lowercase(lexer_->get_current_text()) };
-            auto ten_to_nineteen_number{ word_to_number_map.at(word_lc) };
-            node.add(ast::int_node{ ten_to_nineteen_number });
+            node.add(ast::int_node{ lexer_->get_current_token().value });
             advance_to_next_token(node);
             return true;
         }
@@ -155,9 +126,7 @@ private:
     }
     [[nodiscard]] bool twenty_to_ninety_nine(auto& node) {
         if (lexer_->get_current_lexeme() == lexeme_t::tens) {
-            auto word_lc{ rtc::string::to_lowercase(lexer_->get_current_text()) };
-            auto tens_number{ word_to_number_map.at(word_lc) };
-            node.add(ast::int_node{ tens_number });
+            node.add(ast::int_node{ lexer_->get_current_token().value });
             advance_to_next_token(node);
             if (dash(node)) {
                 return one_to_nine(node);
@@ -270,7 +239,7 @@ private:
         return false;
     }
     [[nodiscard]] bool number_expression(auto& parent_node) {
-        ast::number_expression_node node{};
+        ast::number_expression_node node{ parent_node.get_allocator() };
         if (zero(node) or billions(node)) {
             parent_node.add(std::move(node));
             return true;
@@ -301,18 +270,20 @@ private:
         return (sentence_prefix(node) and sentence_body(node));
     }
 
-    void sentences() {
+    // Every sentence node is handed over to the sentence handler as soon as it is parsed
+    // Sentence nodes are created with the given allocator
+    void sentences(ast::allocator_type allocator, std::invocable<ast::sentence_node&&> auto&& handle_sentence) {
         while (not end()) {
-            ast::sentence_node node{};
+            ast::sentence_node node{ allocator };
             if (sentence(node)) {
-                ast_->add(std::move(node));
+                handle_sentence(std::move(node));
             } else {
                 throw invalid_token_error{ lexer_->get_current_token(), node.dump() };
             }
         }
     }
     void start() {
-        sentences();
+        sentences({}, [this](ast::sentence_node&& node) { ast_->add(std::move(node)); });
     }
 public:
     explicit parser(input_reader_up reader)
@@ -323,6 +294,32 @@ public:
         start();
         return ast_->evaluate();
     }
+    // Streaming parse
+    // Each sentence is evaluated and passed to the callback as soon as it is parsed,
+    // without being added to the AST, so memory is bounded by the longest sentence
+    // Sentence nodes are built in the arena, which is released once the sentence has been evaluated
+    // Sentences are evaluated into the same output buffer, which is reused for every sentence
+    void parse(std::invocable<const std::string&> auto&& on_sentence) {
+        sentences(&arena_, [this, &on_sentence](ast::sentence_node&& node) {
+            {
+                auto sentence_node{ std::move(node) };
+                sentence_output_.clear();
+                sentence_node.evaluate_into(sentence_output_);
+                on_sentence(sentence_output_);
+            }
+            arena_.release();
+        });
+    }
+    // Streaming parse into a sink, e.g. an output buffer or an output writer
+    void parse_into(ast::text_sink auto& sink) {
+        sentences(&arena_, [this, &sink](ast::sentence_node&& node) {
+            {
+                auto sentence_node{ std::move(node) };
+                sentence_node.evaluate_into(sink);
+            }
+            arena_.release();
+        });
+    }
 };
 
 
@@ -0,0 +1,310 @@
+#pragma once
+
+#include "conversion_stats.h"  // thread_cpu_time
+#include "input_reader.h"
+#include "spsc_ring.h"
+#include "trace.h"
+#include "translator.h"
+
+#include <algorithm>  // min
+#include <chrono>
+#include <concepts>  // invocable
+#include <cstring>  // memchr, memcpy
+#include <exception>  // current_exception, exception_ptr, rethrow_exception
+#include <memory>  // make_unique, unique_ptr
+#include <string>
+#include <string_view>
+#include <thread>  // jthread
+#include <vector>
+
+
+// Converts a text in three stages, each one on its own thread: a reader, a converter, and a writer
+// - The reader thread reads sentences from an input reader, e.g. the standard input, and packs them into fixed-size blocks.
+// - The converter, i.e. the calling thread, translates the text of those blocks, and packs the output into other blocks.
+// - The writer thread hands every output block over to a callback, e.g. one writing to the output writers.
+// Blocks go from one stage to the next through single-producer/single-consumer rings, and come back, once used, through others,
+// so the number of blocks in flight is fixed, and a slow stage makes the previous one wait
+// That way, waiting for the input, or for the output, is overlapped with converting the text
+//
+// A stage hands a block over once it is full or, so that a filter still outputs every sentence as soon as it arrives,
+// when the next stage has nothing to do:
+// - the reader hands over a block after a sentence if the converter has no block waiting, and
+// - the converter hands over its output block before waiting for the next input block
+class pipeline_converter {
+public:
+    static constexpr size_t default_block_size{ size_t{ 64 } * 1024 };
+    static constexpr size_t default_blocks{ 8 };
+
+    // CPU time spent by each stage's thread
+    struct cpu_times {
+        std::chrono::nanoseconds read{};
+        std::chrono::nanoseconds convert{};
+        std::chrono::nanoseconds write{};
+    };
+private:
+    struct block {
+        std::vector<char> data{};
+        size_t size{};
+        bool last{};  // the end of the text
+    };
+    using block_ring = spsc_ring<block*>;
+
+    // Thrown in the converter when another stage has stopped the pipeline
+    struct stopped {};
+
+    // Blocks and rings of one conversion
+    struct pipeline {
+        std::vector<block> input_blocks;
+        std::vector<block> output_blocks;
+        block_ring free_input;  // from the converter back to the reader
+        block_ring full_input;  // from the reader to the converter
+        block_ring free_output;  // from the writer back to the converter
+        block_ring full_output;  // from the converter to the writer
+        block* output{ nullptr };  // being filled by the converter
+        std::exception_ptr reader_error{};
+        std::exception_ptr writer_error{};
+
+        pipeline(size_t block_size, size_t blocks)
+            : input_blocks(blocks)
+            , output_blocks(blocks)
+            , free_input{ blocks }
+            , full_input{ blocks }
+            , free_output{ blocks }
+            , full_output{ blocks } {
+
+            for (auto& b : input_blocks) {
+                b.data.resize(block_size);
+                (void) free_input.push(&b);
+            }
+            for (auto& b : output_blocks) {
+                b.data.resize(block_size);
+                (void) free_output.push(&b);
+            }
+        }
+
+        void stop_reader() {
+            free_input.close();
+            full_input.close();
+        }
+        void stop_writer() {
+            free_output.close();
+            full_output.close();
+        }
+
+        // Converter side
+        void hand_over_output(bool last = false) {
+            if (not output) {
+                return;
+            }
+            output->last = last;
+            if (not full_output.push(output)) {
+                throw stopped{};
+            }
+            output = nullptr;
+        }
+        void append_output(std::string_view text) {
+            while (not text.empty()) {
+                if (not output and not free_output.try_pop(output)) {
+                    WORD_CONVERTER_TRACE_SPAN("wait_for_output");
+                    if (not free_output.pop(output)) {
+                        throw stopped{};
+                    }
+                }
+                auto n{ std::min(text.size(), output->data.size() - output->size) };
+                std::memcpy(output->data.data() + output->size, text.data(), n);
+                output->size += n;
+                text.remove_prefix(n);
+                if (output->size == output->data.size()) {
+                    hand_over_output();
+                }
+            }
+        }
+    };
+
+    // Reads sentences from the input blocks, for the translator
+    // Sentences are returned as views into a block, and only copied if they span more than one block
+    class block_reader : public input_reader {
+        pipeline& pipeline_;
+        block* current_{ nullptr };
+        size_t pos_{};
+        std::string sentence_{};  // for sentences spanning more than one block
+        bool eof_{};
+        bool fail_{};
+    private:
+        // Output is handed over before waiting for more input, so that it does not wait with it
+        void next_block() {
+            if (current_) {
+                current_->size = 0;
+                (void) pipeline_.free_input.push(current_);
+                current_ = nullptr;
+            }
+            pos_ = 0;
+            if (not pipeline_.full_input.try_pop(current_)) {
+                pipeline_.hand_over_output();
+                WORD_CONVERTER_TRACE_SPAN("wait_for_input");
+                if (not pipeline_.full_input.pop(current_)) {
+                    throw stopped{};
+                }
+            }
+        }
+    public:
+        explicit block_reader(pipeline& p) : pipeline_{ p } {}
+
+        std::string_view read() override {
+            sentence_.clear();
+            bool copied{ false };
+            while (true) {
+                if (not current_ or pos_ == current_->size) {
+                    if (current_ and current_->last) {
+                        eof_ = true;
+                        fail_ = not copied;
+                        return sentence_;
+                    }
+                    next_block();
+                    continue;
+                }
+                auto begin{ current_->data.data() + pos_ };
+                auto size{ current_->size - pos_ };
+                auto period{ static_cast<const char*>(std::memchr(begin, '.', size)) };
+                if (period) {
+                    size = static_cast<size_t>(period - begin) + 1;
+                }
+                pos_ += size;
+                if (period and not copied) {
+                    return { begin, size };
+                }
+                sentence_.append(begin, size);
+                copied = true;
+                if (period) {
+                    return sentence_;
+                }
+            }
+        }
+        bool eof() override { return eof_; }
+        bool fail() override { return fail_; }
+    };
+
+    size_t block_size_{};
+    size_t blocks_{};
+
+    // Of the last conversion
+    translation_counters counters_{};
+    cpu_times cpu_times_{};
+private:
+    static void read_stage(pipeline& p, input_reader& reader) {
+        try {
+            block* b{ nullptr };
+            if (not p.free_input.pop(b)) {
+                return;
+            }
+            while (not reader.eof()) {
+                auto sentence{ [&reader]() {
+                    WORD_CONVERTER_TRACE_SPAN("read");
+                    return reader.read();
+                }() };
+                while (not sentence.empty()) {
+                    auto n{ std::min(sentence.size(), b->data.size() - b->size) };
+                    std::memcpy(b->data.data() + b->size, sentence.data(), n);
+                    b->size += n;
+                    sentence.remove_prefix(n);
+                    if (b->size == b->data.size() and (not p.full_input.push(b) or not p.free_input.pop(b))) {
+                        return;
+                    }
+                }
+                if (b->size > 0 and p.full_input.empty() and (not p.full_input.push(b) or not p.free_input.pop(b))) {
+                    return;
+                }
+            }
+            b->last = true;
+            (void) p.full_input.push(b);
+        } catch (...) {
+            p.reader_error = std::current_exception();
+            p.full_input.close();
+        }
+    }
+    static void write_stage(pipeline& p, std::invocable<std::string_view> auto& on_output) {
+        try {
+            for (block* b{ nullptr }; p.full_output.pop(b);) {
+                auto last{ b->last };
+                if (b->size > 0) {
+                    on_output(std::string_view{ b->data.data(), b->size });
+                }
+                b->size = 0;
+                b->last = false;
+                if (last or not p.free_output.push(b)) {
+                    return;
+                }
+            }
+        } catch (...) {
+            p.writer_error = std::current_exception();
+            p.stop_writer();
+        }
+    }
+
+    // The text converted before an error is still written out, as a serial conversion would
+    // A reader thread waiting for its input, e.g. a terminal, is only joined once that input arrives, or ends
+    void run(input_reader_up reader, std::invocable<std::string_view> auto& on_output, auto&& translate) {
+        pipeline p{ block_size_, blocks_ };
+        std::exception_ptr error{};
+        counters_ = {};
+        cpu_times_ = {};
+        {
+            auto& times{ cpu_times_ };
+            std::jthread reader_thread{ [&p, &reader, &times]() {
+                WORD_CONVERTER_TRACE_THREAD("reader");
+                auto start{ thread_cpu_time() };
+                read_stage(p, *reader);
+                times.read = thread_cpu_time() - start;
+            } };
+            std::jthread writer_thread{ [&p, &on_output, &times]() {
+                WORD_CONVERTER_TRACE_THREAD("writer");
+                auto start{ thread_cpu_time() };
+                write_stage(p, on_output);
+                times.write = thread_cpu_time() - start;
+            } };
+            auto start{ thread_cpu_time() };
+            try {
+                translator t{ std::make_unique<block_reader>(p) };
+                translate(t, [&p](const std::string& sentence) { p.append_output(sentence); });
+                counters_ = t.get_counters();
+            } catch (const stopped&) {
+            } catch (...) {
+                error = std::current_exception();
+            }
+            p.stop_reader();
+            try {
+                if (not p.output and not p.free_output.pop(p.output)) {
+                    throw stopped{};
+                }
+                p.hand_over_output(true);
+            } catch (const stopped&) {}
+            cpu_times_.convert = thread_cpu_time() - start;
+        }
+        for (const auto& e : { error, p.reader_error, p.writer_error }) {
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        }
+    }
+public:
+    explicit pipeline_converter(size_t block_size = default_block_size, size_t blocks = default_blocks)
+        : block_size_{ std::max<size_t>(block_size, 1) }
+        , blocks_{ std::max<size_t>(blocks, 2) }
+    {}
+
+    // A malformed sentence throws an invalid token error, once the text translated before it has been handed over
+    void convert(input_reader_up reader, std::invocable<std::string_view> auto&& on_output) {
+        run(std::move(reader), on_output, [](translator& t, auto&& on_sentence) { t.translate(on_sentence); });
+    }
+    // Recovery mode
+    // Malformed sentences are passed to on_error, from the calling thread, and copied through
+    void convert(input_reader_up reader, std::invocable<std::string_view> auto&& on_output,
+        std::invocable<const sentence_error&> auto&& on_error) {
+
+        run(std::move(reader), on_output, [&on_error](translator& t, auto&& on_sentence) { t.translate(on_sentence, on_error); });
+    }
+
+    // Of the last conversion, once it has completed
+    [[nodiscard]] translation_counters get_counters() const { return counters_; }
+    [[nodiscard]] cpu_times get_cpu_times() const { return cpu_times_; }
+};
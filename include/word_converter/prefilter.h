@@ -0,0 +1,158 @@
+#pragma once
+
+#include "keyword_table.h"
+
+#include <algorithm>  // min
+#include <array>
+#include <bit>  // countr_zero
+#include <cstdint>  // uint16_t, uint64_t
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WORD_CONVERTER_HAS_SSE2
+#endif
+
+
+// Skip-scan over text that cannot contain number words
+// A word can only be a keyword if a keyword exists with the same first letter and the same length
+// The prefilter looks for word boundaries, and reports the first word passing that check, i.e. a candidate
+// Letters are classified in blocks of 64 bytes, using SSE2 or AVX2 when available
+namespace prefilter {
+
+enum class isa_t {
+    scalar,
+    sse2,
+    avx2
+};
+
+#if defined(__AVX2__)
+inline constexpr isa_t default_isa{ isa_t::avx2 };
+#elif defined(WORD_CONVERTER_HAS_SSE2)
+inline constexpr isa_t default_isa{ isa_t::sse2 };
+#else
+inline constexpr isa_t default_isa{ isa_t::scalar };
+#endif
+
+namespace detail {
+    inline constexpr size_t block_size{ 64 };
+
+    // Bit n of the length mask of a letter is set if there is a keyword of length n starting with that letter
+    using length_masks_t = std::array<uint16_t, 26>;
+
+    [[nodiscard]] constexpr length_masks_t build_length_masks() {
+        length_masks_t ret{};
+        for (const auto& keyword : keywords) {
+            ret[keyword.word[0] - 'a'] |= static_cast<uint16_t>(1u << keyword.word.size());
+        }
+        return ret;
+    }
+    inline constexpr length_masks_t length_masks{ build_length_masks() };
+
+    [[nodiscard]] constexpr bool is_letter(char c) {
+        return ('a' <= c and c <= 'z') or ('A' <= c and c <= 'Z');
+    }
+    [[nodiscard]] constexpr uint16_t get_length_mask(char first_letter) {
+        return length_masks[(first_letter | 0x20) - 'a'];
+    }
+
+    // Bit i of a letter mask is set if p[i] is an ASCII letter
+    [[nodiscard]] inline uint64_t letter_mask_scalar(const char* p, size_t size) {
+        uint64_t ret{};
+        for (size_t i{ 0 }; i < size; ++i) {
+            ret |= uint64_t{ is_letter(p[i]) } << i;
+        }
+        return ret;
+    }
+#if defined(WORD_CONVERTER_HAS_SSE2)
+    // Setting the 0x20 bit lowercases letters, which then fall in the ['a', 'z'] range
+    // Bytes above 0x7f are negative as signed chars, so they are never classified as letters
+    [[nodiscard]] inline uint64_t letter_mask_sse2(const char* p) {
+        const auto case_bit{ _mm_set1_epi8(0x20) };
+        const auto before_a{ _mm_set1_epi8('a' - 1) };
+        const auto after_z{ _mm_set1_epi8('z' + 1) };
+        uint64_t ret{};
+        for (size_t i{ 0 }; i < block_size; i += 16) {
+            auto lowercase{ _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), case_bit) };
+            auto letters{ _mm_and_si128(_mm_cmpgt_epi8(lowercase, before_a), _mm_cmplt_epi8(lowercase, after_z)) };
+            ret |= uint64_t{ static_cast<uint16_t>(_mm_movemask_epi8(letters)) } << i;
+        }
+        return ret;
+    }
+#endif
+#if defined(__AVX2__)
+    [[nodiscard]] inline uint64_t letter_mask_avx2(const char* p) {
+        const auto case_bit{ _mm256_set1_epi8(0x20) };
+        const auto before_a{ _mm256_set1_epi8('a' - 1) };
+        const auto after_z{ _mm256_set1_epi8('z' + 1) };
+        uint64_t ret{};
+        for (size_t i{ 0 }; i < block_size; i += 32) {
+            auto lowercase{ _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), case_bit) };
+            auto letters{ _mm256_and_si256(_mm256_cmpgt_epi8(lowercase, before_a), _mm256_cmpgt_epi8(after_z, lowercase)) };
+            ret |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(letters)) } << i;
+        }
+        return ret;
+    }
+#endif
+
+    template <isa_t Isa>
+    [[nodiscard]] uint64_t letter_mask(const char* p, size_t size) {
+        if (size < block_size) {
+            return letter_mask_scalar(p, size);
+        }
+#if defined(__AVX2__)
+        if constexpr (Isa == isa_t::avx2) {
+            return letter_mask_avx2(p);
+        }
+#endif
+#if defined(WORD_CONVERTER_HAS_SSE2)
+        if constexpr (Isa == isa_t::sse2) {
+            return letter_mask_sse2(p);
+        }
+#endif
+        return letter_mask_scalar(p, size);
+    }
+}  // namespace detail
+
+[[nodiscard]] constexpr bool could_be_keyword(char first_letter, size_t length) {
+    return detail::is_letter(first_letter) and
+        length < 16 and
+        (detail::get_length_mask(first_letter) & (1u << length)) != 0;
+}
+
+// Returns the position of the first candidate word starting at or after pos, or npos if there is none
+template <isa_t Isa = default_isa>
+[[nodiscard]] size_t find_candidate(std::string_view text, size_t pos) {
+    using namespace detail;
+    bool previous_is_letter{ pos > 0 and pos <= text.size() and is_letter(text[pos - 1]) };
+    while (pos < text.size()) {
+        auto size{ std::min(text.size() - pos, block_size) };
+        auto letters{ letter_mask<Isa>(text.data() + pos, size) };
+        // Word starts are letters not preceded by a letter
+        auto starts{ letters & ~((letters << 1) | uint64_t{ previous_is_letter }) };
+        for (; starts != 0; starts &= starts - 1) {
+            auto i{ static_cast<size_t>(std::countr_zero(starts)) };
+            auto start{ pos + i };
+            if (get_length_mask(text[start]) == 0) {
+                continue;
+            }
+            size_t end{};
+            if (auto non_letters{ ~letters >> i }; non_letters != 0 and i + std::countr_zero(non_letters) < size) {
+                end = start + std::countr_zero(non_letters);
+            } else {  // the word goes on after this block
+                for (end = pos + size; end < text.size() and is_letter(text[end]); ++end);
+            }
+            if (could_be_keyword(text[start], end - start)) {
+                return start;
+            }
+        }
+        previous_is_letter = (letters >> (size - 1)) & 1;
+        pos += size;
+    }
+    return std::string_view::npos;
+}
+
+}  // namespace prefilter
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <bit>  // bit_ceil
+#include <cstdint>  // uint32_t
+#include <utility>  // move
+#include <vector>
+
+
+// Lock-free single-producer/single-consumer ring buffer
+// One thread pushes, and another one pops; neither takes a lock, they only publish their own index
+// Each side keeps a copy of the other side's index, and only reads the shared one when its copy says the ring is full or empty
+// The indices live on separate cache lines, so the producer and the consumer do not invalidate each other's line on every operation
+// push and pop block, with backpressure: a producer waits while the ring is full, and a consumer waits while it is empty
+// They spin for a while, and then sleep on an atomic wait, which the other side only notifies if someone is sleeping
+// Closing the ring wakes both sides up: push then fails, and pop fails once the ring is empty
+template <typename T>
+class spsc_ring {
+    static constexpr size_t cache_line_size{ 64 };
+    static constexpr int spins{ 256 };
+
+    std::vector<T> slots_{};
+    size_t mask_{};
+    // Next slot to pop, written by the consumer, and the consumer's copy of tail_
+    alignas(cache_line_size) std::atomic<size_t> head_{ 0 };
+    size_t cached_tail_{ 0 };
+    // Next slot to push, written by the producer, and the producer's copy of head_
+    alignas(cache_line_size) std::atomic<size_t> tail_{ 0 };
+    size_t cached_head_{ 0 };
+    // Bumped on every push, pop, and close, so that a sleeping side can wait on it
+    alignas(cache_line_size) std::atomic<uint32_t> sequence_{ 0 };
+    std::atomic<uint32_t> sleepers_{ 0 };
+    std::atomic<bool> closed_{ false };
+private:
+    void wake() {
+        sequence_.fetch_add(1);
+        if (sleepers_.load() > 0) {
+            sequence_.notify_all();
+        }
+    }
+    void wait_until(auto&& ready) {
+        for (int i{ 0 }; i < spins; ++i) {
+            if (ready()) {
+                return;
+            }
+        }
+        while (true) {
+            sleepers_.fetch_add(1);
+            auto sequence{ sequence_.load() };
+            if (ready()) {
+                sleepers_.fetch_sub(1);
+                return;
+            }
+            sequence_.wait(sequence);
+            sleepers_.fetch_sub(1);
+        }
+    }
+public:
+    // The capacity is rounded up to a power of two
+    explicit spsc_ring(size_t capacity)
+        : slots_(std::bit_ceil(capacity == 0 ? size_t{ 1 } : capacity))
+        , mask_{ slots_.size() - 1 }
+    {}
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    [[nodiscard]] size_t capacity() const { return slots_.size(); }
+    // Can be called from either side, but it is only a snapshot
+    [[nodiscard]] bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] bool closed() const { return closed_.load(); }
+
+    // Producer side
+    [[nodiscard]] bool try_push(T& value) {
+        auto tail{ tail_.load(std::memory_order_relaxed) };
+        if (tail - cached_head_ == slots_.size()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == slots_.size()) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+    // Returns false, without pushing the value, if the ring is closed
+    [[nodiscard]] bool push(T value) {
+        while (not closed()) {
+            if (try_push(value)) {
+                return true;
+            }
+            wait_until([this]() {
+                return closed() or tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) < slots_.size();
+            });
+        }
+        return false;
+    }
+
+    // Consumer side
+    [[nodiscard]] bool try_pop(T& value) {
+        auto head{ head_.load(std::memory_order_relaxed) };
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+    // Returns false if the ring is closed, and there is nothing left to pop
+    [[nodiscard]] bool pop(T& value) {
+        while (true) {
+            if (try_pop(value)) {
+                return true;
+            }
+            if (closed()) {
+                return try_pop(value);
+            }
+            wait_until([this]() {
+                return closed() or head_.load(std::memory_order_relaxed) != tail_.load(std::memory_order_acquire);
+            });
+        }
+    }
+
+    // Either side, or a third one, can close the ring
+    void close() {
+        closed_.store(true);
+        wake();
+    }
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "output_writer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>  // uint32_t, uint64_t
+#include <deque>
+#include <fmt/format.h>
+#include <iterator>  // back_inserter
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+// Spans recorded by a trace recorder
+// Every span is a complete event, and nested spans, e.g. the read of a sentence during the translation of another one,
+// are shown one below the other
+// Span and thread names are written out as they are, so they must not need escaping in JSON
+//
+// The instrumentation is only compiled in if WORD_CONVERTER_TRACING is defined
+// Otherwise, the macros expand to nothing, and their arguments are not evaluated
+#ifdef WORD_CONVERTER_TRACING
+#define WORD_CONVERTER_TRACE_CONCAT_IMPL(a, b) a##b
+#define WORD_CONVERTER_TRACE_CONCAT(a, b) WORD_CONVERTER_TRACE_CONCAT_IMPL(a, b)
+// Records a span from here to the end of the enclosing scope, optionally with the offset of the text it works on
+#define WORD_CONVERTER_TRACE_SPAN(...) trace_span WORD_CONVERTER_TRACE_CONCAT(trace_span_, __LINE__){ __VA_ARGS__ }
+// Names the calling thread in the trace
+#define WORD_CONVERTER_TRACE_THREAD(name) trace_recorder::set_thread_name(name)
+#else
+#define WORD_CONVERTER_TRACE_SPAN(...) static_cast<void>(0)
+#define WORD_CONVERTER_TRACE_THREAD(name) static_cast<void>(0)
+#endif
+
+
+// Records spans on every thread, and writes them out as Chrome trace-event JSON, which Perfetto, or chrome://tracing, can open
+// Spans are only recorded while a recorder is alive; a thread records its spans into a buffer of its own,
+// so recording a span only takes a lock the first time a thread records one
+// Every thread keeps at most max_events spans, and drops, but counts, the ones after them
+// A recorder must only be written out, or destroyed, once the threads recording into it are done
+class trace_recorder {
+public:
+    static constexpr size_t default_max_events{ size_t{ 1 } << 20 };
+
+    using clock = std::chrono::steady_clock;
+private:
+    struct event {
+        const char* name{};
+        clock::duration start{};  // since the recorder was created
+        clock::duration duration{};
+        std::optional<uint64_t> offset{};
+    };
+    struct thread_events {
+        uint32_t tid{};
+        std::string name{};
+        std::vector<event> events{};
+        uint64_t dropped{};
+    };
+
+    static inline std::atomic<trace_recorder*> current_{ nullptr };
+    static inline std::atomic<uint64_t> next_id_{ 1 };
+
+    clock::time_point start_{ clock::now() };
+    size_t max_events_{};
+    uint64_t id_{ next_id_.fetch_add(1) };  // tells a recorder from an earlier one created at the same address
+    trace_recorder* previous_{};
+    std::mutex mutex_{};
+    std::deque<thread_events> threads_{};  // a deque, so that every thread can keep a reference to its buffer
+private:
+    [[nodiscard]] thread_events& get_thread_events() {
+        struct cache {
+            uint64_t recorder_id{};
+            thread_events* events{};
+        };
+        thread_local cache cached{};
+        if (cached.recorder_id != id_) {
+            std::lock_guard lock{ mutex_ };
+            auto tid{ static_cast<uint32_t>(threads_.size() + 1) };
+            threads_.push_back({ tid, fmt::format("thread {}", tid), {}, 0 });
+            cached = { id_, &threads_.back() };
+        }
+        return *cached.events;
+    }
+    [[nodiscard]] static std::string to_microseconds(clock::duration d) {
+        auto ns{ std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() };
+        return fmt::format("{}.{:03}", ns / 1000, ns % 1000);
+    }
+public:
+    explicit trace_recorder(size_t max_events = default_max_events)
+        : max_events_{ max_events }
+        , previous_{ current_.exchange(this) }
+    {}
+    trace_recorder(const trace_recorder&) = delete;
+    trace_recorder& operator=(const trace_recorder&) = delete;
+    ~trace_recorder() {
+        current_.store(previous_);
+    }
+
+    // The recorder spans are recorded into, if any
+    [[nodiscard]] static trace_recorder* get_current() {
+        return current_.load(std::memory_order_acquire);
+    }
+    static void set_thread_name(const char* name) {
+        if (auto recorder{ get_current() }) {
+            recorder->get_thread_events().name = name;
+        }
+    }
+
+    void record(const char* name, clock::time_point start, clock::time_point end, std::optional<uint64_t> offset = std::nullopt) {
+        auto& t{ get_thread_events() };
+        if (t.events.size() == max_events_) {
+            ++t.dropped;
+            return;
+        }
+        t.events.push_back({ name, start - start_, end - start, offset });
+    }
+
+    [[nodiscard]] size_t get_event_count() const {
+        size_t ret{};
+        for (const auto& t : threads_) {
+            ret += t.events.size();
+        }
+        return ret;
+    }
+    [[nodiscard]] uint64_t get_dropped_event_count() const {
+        uint64_t ret{};
+        for (const auto& t : threads_) {
+            ret += t.dropped;
+        }
+        return ret;
+    }
+
+    // A JSON object with a traceEvents array: a thread name metadata event per thread, and a complete event per span,
+    // with timestamps and durations in microseconds, and the number of dropped spans
+    // Events are formatted, and written out, a few thousand at a time
+    void write(output_writer& writer) const {
+        static constexpr size_t events_per_write{ 4096 };
+        fmt::memory_buffer buffer{};
+        auto out{ std::back_inserter(buffer) };
+        fmt::format_to(out, R"({{"displayTimeUnit":"ns","traceEvents":[)");
+        const char* separator{ "\n" };
+        size_t events_in_buffer{ 0 };
+        auto flush_buffer = [&buffer, &writer, &events_in_buffer]() {
+            writer.write({ buffer.data(), buffer.size() });
+            buffer.clear();
+            events_in_buffer = 0;
+        };
+        for (const auto& t : threads_) {
+            fmt::format_to(out, R"({}{{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+                separator, t.tid, t.name);
+            separator = ",\n";
+            for (const auto& e : t.events) {
+                fmt::format_to(out, R"({}{{"name":"{}","cat":"word_converter","ph":"X","pid":1,"tid":{},"ts":{},"dur":{})",
+                    separator, e.name, t.tid, to_microseconds(e.start), to_microseconds(e.duration));
+                if (e.offset) {
+                    fmt::format_to(out, R"(,"args":{{"offset":{}}})", e.offset.value());
+                }
+                fmt::format_to(out, "}}");
+                if (++events_in_buffer == events_per_write) {
+                    flush_buffer();
+                }
+            }
+        }
+        fmt::format_to(out, "\n],\"otherData\":{{\"dropped_events\":{}}}}}\n", get_dropped_event_count());
+        flush_buffer();
+    }
+};
+
+
+// Records a span, from its construction to its destruction, if a trace recorder is alive
+// Otherwise, it only checks for one, without reading the clock
+class trace_span {
+    trace_recorder* recorder_{ trace_recorder::get_current() };
+    const char* name_{};
+    std::optional<uint64_t> offset_{};
+    trace_recorder::clock::time_point start_{};
+public:
+    explicit trace_span(const char* name, std::optional<uint64_t> offset = std::nullopt)
+        : name_{ name }
+        , offset_{ offset } {
+
+        if (recorder_) {
+            start_ = trace_recorder::clock::now();
+        }
+    }
+    trace_span(const trace_span&) = delete;
+    trace_span& operator=(const trace_span&) = delete;
+    ~trace_span() {
+        if (recorder_) {
+            recorder_->record(name_, start_, trace_recorder::clock::now(), offset_);
+        }
+    }
+};
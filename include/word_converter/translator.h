@@ -0,0 +1,279 @@
+#pragma once
+
+#include "ast.h"  // invalid_number_expression_error, number_expression_stack, text_sink
+#include "input_reader.h"
+#include "lexer.h"
+#include "number_expression_machine.h"
+#include "parser.h"  // invalid_token_error
+#include "trace.h"
+
+#include <concepts>  // invocable
+#include <cstdint>  // uint64_t
+#include <expected>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <memory>  // make_unique, unique_ptr
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+// Malformed sentence, as reported by a translator in recovery mode
+struct sentence_error {
+    size_t offset{};  // of the sentence in the input text, in bytes
+    std::string sentence{};  // as found in the input text
+    std::string message{};  // same as that of the invalid token error a translator would throw
+};
+inline std::ostream& operator<<(std::ostream& os, const sentence_error& e) {
+    return os << fmt::format("{}: {}, in sentence: '{}'", e.offset, e.message, escape_escape_sequences(e.sentence));
+}
+template <>
+struct fmt::formatter<sentence_error> : fmt::ostream_formatter {};
+
+
+// What a translator has gone through so far
+struct translation_counters {
+    uint64_t sentences{};
+    uint64_t tokens{};
+    uint64_t number_expressions{};
+
+    translation_counters& operator+=(const translation_counters& other) {
+        sentences += other.sentences;
+        tokens += other.tokens;
+        number_expressions += other.number_expressions;
+        return *this;
+    }
+    [[nodiscard]] bool operator==(const translation_counters& other) const = default;
+};
+
+
+// Single-pass translator
+// Runs the same grammar as the parser, but translates the text as its tokens are recognized, without building an AST:
+// - text is copied through to the output of the current sentence,
+// - number words are pushed straight into a number expression stack, and
+// - once a number expression ends, its value and its last text (e.g. the space separating it from the next word) are written out
+// The parser remains the way to get an AST, e.g. to dump the input text
+class translator {
+    std::unique_ptr<lexer> lexer_{};
+
+    // Output of the sentence being translated, reused for every sentence
+    std::string sentence_output_{};
+
+    // State of the number expression being translated
+    // Only the last text of a number expression is written out, and only if no number word follows it
+    number_expression_stack numbers_{};
+    std::string number_expression_text_{};
+    bool in_number_expression_{ false };
+    // Invalid number expression of the sentence being translated, e.g. '100 100', if any
+    std::optional<std::string> invalid_number_expression_{};
+
+    uint64_t sentences_{ 0 };
+    uint64_t number_expressions_{ 0 };
+private:
+    void add_text(std::string_view text) {
+        if (in_number_expression_) {
+            number_expression_text_.assign(text);
+        } else {
+            sentence_output_.append(text);
+        }
+    }
+    [[nodiscard]] bool add_number(int number) {
+        if (auto result{ numbers_.try_push(number) }; not result) {
+            invalid_number_expression_ = std::move(result.error());
+            return false;
+        }
+        number_expression_text_.clear();
+        return true;
+    }
+    void advance_to_next_token() {
+        lexer_->advance_to_next_token();
+        if (lexer_->get_current_lexeme() == lexeme_t::space) {
+            add_text(lexer_->get_current_text());
+            lexer_->advance_to_next_token();
+        }
+    }
+    [[nodiscard]] bool text(lexeme_t lexeme) {
+        if (lexer_->get_current_lexeme() == lexeme) {
+            add_text(lexer_->get_current_text());
+            advance_to_next_token();
+            return true;
+        }
+        return false;
+    }
+private:
+    [[nodiscard]] bool end() {
+        return (lexer_->get_current_lexeme() == lexeme_t::end);
+    }
+    [[nodiscard]] bool space() { return text(lexeme_t::space); }
+    [[nodiscard]] bool dash() { return text(lexeme_t::dash); }
+    // A period ends a sentence, so the token after it is not read until the sentence has been handed over
+    // That way, a sentence is output as soon as its period arrives, even if the input is waiting for the next one
+    [[nodiscard]] bool period() {
+        if (lexer_->get_current_lexeme() == lexeme_t::period) {
+            add_text(lexer_->get_current_text());
+            return true;
+        }
+        return false;
+    }
+    [[nodiscard]] bool and_connector() { return text(lexeme_t::and_connector); }
+    [[nodiscard]] bool other() { return text(lexeme_t::other); }
+    // Number expressions are recognized by a state machine, which examines every token once
+    // A number expression either starts with a number word or does not consume any token
+    // A number expression the machine accepts can still be invalid, e.g. 'one hundred hundred', and then fails the sentence
+    [[nodiscard]] bool number_expression() {
+        using namespace number_expression_machine;
+        auto state{ next(state_t::start, lexer_->get_current_lexeme()) };
+        if (is_final(state)) {
+            return false;
+        }
+        numbers_.clear();
+        number_expression_text_.clear();
+        in_number_expression_ = true;
+        do {
+            if (auto lexeme{ lexer_->get_current_lexeme() }; lexeme == lexeme_t::and_connector or lexeme == lexeme_t::dash) {
+                add_text(lexer_->get_current_text());
+            } else if (not add_number(lexer_->get_current_token().value)) {
+                in_number_expression_ = false;
+                return false;
+            }
+            advance_to_next_token();
+            state = next(state, lexer_->get_current_lexeme());
+        } while (not is_final(state));
+        in_number_expression_ = false;
+        if (state == state_t::reject) {
+            return false;
+        }
+        ast::append_number(sentence_output_, numbers_.value());
+        sentence_output_.append(number_expression_text_);
+        ++number_expressions_;
+        return true;
+    }
+    [[nodiscard]] bool text_without_number_expression() {
+        return (space() or dash() or and_connector() or other());
+    }
+    [[nodiscard]] bool text_without_number_expressions() {
+        while (text_without_number_expression());
+        return true;
+    }
+    [[nodiscard]] bool rest_of_sentence_body() {
+        return end() or
+            period() or
+            (text_without_number_expression() and sentence());
+    }
+    [[nodiscard]] bool sentence_body() {
+        return end() or
+            period() or
+            (number_expression() and rest_of_sentence_body());
+    }
+    [[nodiscard]] bool sentence_prefix() {
+        return (text_without_number_expressions());
+    }
+    [[nodiscard]] bool sentence() {
+        return (sentence_prefix() and sentence_body());
+    }
+    // Translates the sentence starting at the current token into the sentence output
+    // Errors are returned instead of thrown, so recovering from many malformed sentences does not unwind the stack for every one
+    // Number expressions of a malformed sentence are not counted, as they are not written out
+    [[nodiscard]] std::expected<void, sentence_error> translate_sentence() {
+        WORD_CONVERTER_TRACE_SPAN("translate", lexer_->get_current_sentence_offset());
+        auto number_expressions{ number_expressions_ };
+        invalid_number_expression_.reset();
+        if (sentence()) {
+            return {};
+        }
+        number_expressions_ = number_expressions;
+        return std::unexpected{ sentence_error{
+            lexer_->get_current_sentence_offset(),
+            std::string{ lexer_->get_current_sentence() },
+            invalid_number_expression_
+                ? invalid_number_expression_error{ invalid_number_expression_.value() }.what()
+                : invalid_token_error::make_message(lexer_->get_current_token(), sentence_output_)
+        } };
+    }
+    // Replaces the output of a malformed sentence with its input text, and skips the rest of its tokens
+    // Every sentence read ends with a period, but maybe the last one, so the first period found is that of the malformed sentence
+    void copy_sentence_through() {
+        while (lexer_->get_current_lexeme() != lexeme_t::period and lexer_->get_current_lexeme() != lexeme_t::end) {
+            lexer_->advance_to_next_token();
+        }
+        sentence_output_.assign(lexer_->get_current_sentence());
+        in_number_expression_ = false;
+    }
+    // The text following a period, e.g. a space or a new line, goes with the next sentence
+    void hand_over_sentence(std::invocable<const std::string&> auto& on_sentence) {
+        ++sentences_;
+        on_sentence(sentence_output_);
+        sentence_output_.clear();
+        if (lexer_->get_current_lexeme() == lexeme_t::period) {
+            advance_to_next_token();
+        }
+    }
+    void hand_over_rest(std::invocable<const std::string&> auto& on_sentence) {
+        if (not sentence_output_.empty()) {  // e.g. a new line after the last period
+            ++sentences_;
+            on_sentence(sentence_output_);
+        }
+    }
+public:
+    explicit translator(input_reader_up reader)
+        : lexer_{ std::make_unique<lexer>(std::move(reader)) }
+    {}
+    // Translates a new input, reusing the lexer, its pool of coroutine frames, and the output buffers
+    void reset(input_reader_up reader) {
+        lexer_->reset(std::move(reader));
+        sentence_output_.clear();
+        numbers_.clear();
+        number_expression_text_.clear();
+        in_number_expression_ = false;
+        invalid_number_expression_.reset();
+        sentences_ = 0;
+        number_expressions_ = 0;
+    }
+    [[nodiscard]] translation_counters get_counters() const {
+        return { sentences_, lexer_->get_token_count(), number_expressions_ };
+    }
+    // Each sentence is translated into the same output buffer, which is passed to the callback as soon as its period is found
+    // A malformed sentence throws an invalid token error, and the text translated so far for that sentence is reported,
+    // or an invalid number expression error
+    void translate(std::invocable<const std::string&> auto&& on_sentence) {
+        sentence_output_.clear();
+        while (not end()) {
+            if (auto result{ translate_sentence() }; not result) {
+                if (invalid_number_expression_) {
+                    throw invalid_number_expression_error{ invalid_number_expression_.value() };
+                }
+                throw invalid_token_error{ std::move(result.error().message) };
+            }
+            hand_over_sentence(on_sentence);
+        }
+        hand_over_rest(on_sentence);
+    }
+    // Recovery mode
+    // A malformed sentence is passed to on_error, and then to on_sentence, unchanged, and translation resumes after its period
+    void translate(std::invocable<const std::string&> auto&& on_sentence, std::invocable<const sentence_error&> auto&& on_error) {
+        sentence_output_.clear();
+        while (not end()) {
+            if (auto result{ translate_sentence() }; not result) {
+                copy_sentence_through();
+                on_error(result.error());
+            }
+            hand_over_sentence(on_sentence);
+        }
+        hand_over_rest(on_sentence);
+    }
+    // Translation into a sink, e.g. an output buffer or an output writer
+    void translate_into(ast::text_sink auto& sink) {
+        translate([&sink](const std::string& sentence) { sink.append(sentence); });
+    }
+    void translate_into(ast::text_sink auto& sink, std::invocable<const sentence_error&> auto&& on_error) {
+        translate([&sink](const std::string& sentence) { sink.append(sentence); }, on_error);
+    }
+    [[nodiscard]] std::string translate() {
+        std::string ret{};
+        translate_into(ret);
+        return ret;
+    }
+};
+
+
+using translator_up = std::unique_ptr<translator>;
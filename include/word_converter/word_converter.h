@@ -0,0 +1,85 @@
+#ifndef WORD_CONVERTER_WORD_CONVERTER_H
+#define WORD_CONVERTER_WORD_CONVERTER_H
+
+/*
+ * C API of the word_converter library
+ *
+ * Converts the numbers written in words of a text into digits, in process, from C or C++
+ * Only types and functions declared here are exported, and their layout and signatures do not change within a major version
+ */
+
+#include <stddef.h>  /* size_t */
+
+#if defined(_WIN32) && defined(WORD_CONVERTER_SHARED)
+#if defined(WORD_CONVERTER_BUILDING_LIB)
+#define WC_API __declspec(dllexport)
+#else
+#define WC_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+#define WC_API __attribute__((visibility("default")))
+#else
+#define WC_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef enum wc_status {
+    WC_OK = 0,
+    WC_INVALID_ARGUMENT = 1,  /* e.g. a null output buffer */
+    WC_INVALID_TEXT = 2,  /* the text is malformed, e.g. "one two" */
+    WC_OUT_OF_MEMORY = 3,
+    WC_ERROR = 4
+} wc_status;
+
+
+/*
+ * Converted text
+ * The text is owned by the context that converted it, and is valid until the next conversion with that context,
+ * or until the context is destroyed
+ * It is not null-terminated
+ */
+typedef struct wc_buffer {
+    const char* data;
+    size_t size;
+} wc_buffer;
+
+
+/*
+ * Conversion context
+ * Keeps a translator and its scratch buffers from one conversion to the next, so converting many texts does not reallocate them
+ * A context must not be used by two threads at the same time
+ */
+typedef struct wc_context wc_context;
+
+/* Returns null if the context could not be allocated */
+WC_API wc_context* wc_context_create(void);
+/* Destroying a null context does nothing */
+WC_API void wc_context_destroy(wc_context* context);
+
+/*
+ * Converts len bytes of text starting at in, and points out to the converted text
+ * A null context uses a context owned by the calling thread
+ * If the text cannot be converted, out is left empty, and the reason is returned by wc_last_error
+ */
+WC_API wc_status wc_convert(wc_context* context, const char* in, size_t len, wc_buffer* out);
+
+/*
+ * Error message of the last failed conversion with a context, or an empty string if the last conversion succeeded
+ * A null context returns the error of the context owned by the calling thread
+ * The message is valid until the next conversion with that context
+ */
+WC_API const char* wc_last_error(const wc_context* context);
+
+/* Name of a status, e.g. "WC_INVALID_TEXT" */
+WC_API const char* wc_status_name(wc_status status);
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif  /* WORD_CONVERTER_WORD_CONVERTER_H */
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>  // max, min
+#include <deque>
+#include <exception>  // exception_ptr, rethrow_exception
+#include <functional>  // function
+#include <mutex>
+#include <optional>
+#include <thread>  // jthread
+#include <vector>
+
+
+// Runs a set of independent tasks on a pool of worker threads
+// Every worker owns a queue of tasks. Tasks are dealt to the queues in round-robin
+// A worker takes tasks from the front of its own queue, and, once it is empty, steals from the back of the other queues
+// That way, a worker stuck on a long task does not hold up the tasks that were dealt to it
+class work_stealing_pool {
+public:
+    using task_t = std::function<void()>;
+
+    explicit work_stealing_pool(size_t workers) : workers_{ std::max(workers, size_t{ 1 }) } {}
+
+    // Returns once all the tasks have run
+    // If any task throws, the remaining tasks still run, and the first exception is rethrown at the end
+    void run(std::vector<task_t> tasks) {
+        auto workers{ std::min(workers_, tasks.size()) };
+        if (workers == 0) {
+            return;
+        }
+        std::vector<task_queue> queues(workers);
+        for (size_t i{ 0 }; i < tasks.size(); ++i) {
+            queues[i % workers].tasks.push_back(i);
+        }
+
+        std::mutex error_mutex{};
+        std::exception_ptr error{};
+        auto worker = [&](size_t self) {
+            while (auto i{ pop_or_steal(queues, self) }) {
+                try {
+                    tasks[*i]();
+                } catch (...) {
+                    std::lock_guard lock{ error_mutex };
+                    if (not error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+        {
+            std::vector<std::jthread> threads{};
+            for (size_t self{ 0 }; self < workers; ++self) {
+                threads.emplace_back(worker, self);
+            }
+        }  // join workers
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+private:
+    struct task_queue {
+        std::mutex mutex{};
+        std::deque<size_t> tasks{};
+    };
+
+    size_t workers_{};
+
+    // No tasks are added once the workers have started, so a worker can finish as soon as all the queues are empty
+    [[nodiscard]] static std::optional<size_t> pop_or_steal(std::vector<task_queue>& queues, size_t self) {
+        {
+            auto& own{ queues[self] };
+            std::lock_guard lock{ own.mutex };
+            if (not own.tasks.empty()) {
+                auto ret{ own.tasks.front() };
+                own.tasks.pop_front();
+                return ret;
+            }
+        }
+        for (size_t k{ 1 }; k < queues.size(); ++k) {
+            auto& victim{ queues[(self + k) % queues.size()] };
+            std::lock_guard lock{ victim.mutex };
+            if (not victim.tasks.empty()) {
+                auto ret{ victim.tasks.back() };
+                victim.tasks.pop_back();
+                return ret;
+            }
+        }
+        return std::nullopt;
+    }
+};
@@ -1,45 +1,388 @@
+#include "batch_converter.h"
 #include "command_line_parser.h"
+#include "conversion_server.h"
+#include "conversion_stats.h"
 #include "input_reader.h"
 #include "output_writer.h"
-#include "parser.h"
+#include "parallel_converter.h"
+#include "pipeline_converter.h"
+#include "trace.h"
+#include "translator.h"
 
+#include <algorithm>  // for_each, move
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>  // signal, SIGINT, SIGTERM
 #include <exception>
+#include <filesystem>
 #include <fmt/ostream.h>
-#include <iostream>  // cout
-#include <memory>  // make_unique
+#include <iostream>  // cerr, cin, cout
+#include <iterator>  // back_inserter
+#include <memory>  // make_unique, unique_ptr
+#include <optional>
+#include <string_view>
+#include <system_error>  // error_code
+#include <utility>  // move
 #include <vector>
 
+#ifndef _WIN32
+#include <unistd.h>  // STDOUT_FILENO
+#endif
+
+namespace fs = std::filesystem;
+
 
 void print_usage(std::ostream& os) {
     fmt::print(os, "Usage:\n");
-    fmt::print(os, "\tword_converter -i <INPUT_FILE_PATH> [-o <OUTPUT_FILE_PATH>]\n");
+    fmt::print(os, "\tword_converter -i <INPUT_FILE_PATH> [-o <OUTPUT_FILE_PATH>] [-j <JOBS>] [-f <FLUSH>] [--recover <ERROR_REPORT_PATH>]"
+        " [--io <IO>] [--pipeline <BLOCK_SIZE>] [--stats[=<STATS>]] [--trace <TRACE_PATH>]\n");
+    fmt::print(os, "\tword_converter -i <INPUT_PATH> [-i <INPUT_PATH>...] [-l <LIST_FILE_PATH>] -o <OUTPUT_DIR_PATH> [-j <JOBS>]"
+        " [--recover <ERROR_REPORT_PATH>]\n");
+    fmt::print(os, "\tword_converter --serve <SOCKET_PATH>\n");
     fmt::print(os, "Where:\n");
-    fmt::print(os, "\tINPUT_FILE_PATH   Path to an input text file.\n");
-    fmt::print(os, "\tOUTPUT_FILE_PATH  Path to an output text file. This parameter is optional.\n");
+    fmt::print(os, "\tINPUT_FILE_PATH   Path to an input text file, or - for the standard input.\n");
+    fmt::print(os, "\tOUTPUT_FILE_PATH  Path to an output text file, or - for the standard output only. This parameter is optional.\n");
+    fmt::print(os, "\tINPUT_PATH        Path to an input text file, or to a directory of input text files.\n");
+    fmt::print(os, "\tLIST_FILE_PATH    Path to a file listing input paths, one per line.\n");
+    fmt::print(os, "\tOUTPUT_DIR_PATH   Path to the output directory. Output files mirror the input paths.\n");
+    fmt::print(os, "\tERROR_REPORT_PATH Path to an error report file. This parameter is optional.\n");
+    fmt::print(os, "\t                  If given, malformed sentences are copied through unchanged, and reported, together with their offset.\n");
+    fmt::print(os, "\tTRACE_PATH        Path to a trace file. This parameter is optional. If given, the read, translation, and write\n");
+    fmt::print(os, "\t                  of every sentence, on every thread, are written to it as Chrome trace-event JSON.\n");
+    fmt::print(os, "\tSOCKET_PATH       Path to a Unix domain socket. Conversion requests sent to it are served until interrupted.\n");
+    fmt::print(os, "\tJOBS              Number of threads converting the input text. This parameter is optional.\n");
+    fmt::print(os, "\t                  The standard input is always converted by one thread.\n");
+    fmt::print(os, "\tIO                How input and output files are read and written: mmap, uring (io_uring, or read and write\n");
+    fmt::print(os, "\t                  if it is not available), or read (read and write). This parameter is optional, and defaults to mmap.\n");
+    fmt::print(os, "\tBLOCK_SIZE        Size of the blocks handed over between a reader, a converter, and a writer thread,\n");
+    fmt::print(os, "\t                  a number of bytes (e.g. 64K). This parameter is optional. If given, and JOBS is 1, or the input\n");
+    fmt::print(os, "\t                  is the standard input, the input is read, converted, and written out by three pipelined threads.\n");
+    fmt::print(os, "\tSTATS             How the time spent reading, converting, and writing, and the bytes, sentences, tokens,\n");
+    fmt::print(os, "\t                  and number expressions gone through, are printed out to the standard error: text, or json.\n");
+    fmt::print(os, "\t                  This parameter is optional, and defaults to text.\n");
+    fmt::print(os, "\tFLUSH             When the output is flushed: sentence, a number of bytes (e.g. 4096 or 64K),\n");
+    fmt::print(os, "\t                  or a number of milliseconds (e.g. 20ms). This parameter is optional, and can be repeated.\n");
+    fmt::print(os, "\t                  Defaults to sentence when reading from the standard input or writing to the standard output.\n");
     fmt::print(os, "Example:\n");
     fmt::print(os, "\tword_converter -i in.txt\n");
     fmt::print(os, "\tword_converter -i in.txt -o out.txt\n");
+    fmt::print(os, "\tword_converter -i in.txt -o out.txt -j 8\n");
+    fmt::print(os, "\tword_converter -i in_dir -i in.txt -o out_dir -j 8\n");
+    fmt::print(os, "\tword_converter -i in.txt -o out.txt --io uring\n");
+    fmt::print(os, "\tword_converter -i - -o -\n");
+    fmt::print(os, "\tword_converter -i - -o - --pipeline 64K\n");
+    fmt::print(os, "\tword_converter -i in.txt -o out.txt --stats=json\n");
+    fmt::print(os, "\tword_converter -i in.txt -o out.txt -j 8 --trace trace.json\n");
+    fmt::print(os, "\tword_converter --serve /tmp/word_converter.sock\n");
 }
 
 
-int main_impl(std::ostream& os, int argc, const char** argv) {
-    try {
-        // Parse command line options
-        auto options{ command_line_parser::parse(argc, argv) };
+// - stands for the standard input or output
+[[nodiscard]] bool is_standard_stream(const std::string& path) {
+    return path == "-";
+}
+
+
+// Batch mode is used for more than one input, a directory, or a list file
+[[nodiscard]] bool is_batch(const command_line_options& options) {
+    std::error_code ec{};
+    return options.input_files.size() > 1 or
+        options.list_file or
+        (not is_standard_stream(options.input_files.front()) and fs::is_directory(options.input_files.front(), ec));
+}
+
+
+#ifndef _WIN32
+[[nodiscard]] io_backend to_io_backend(io_mode mode) {
+    return mode == io_mode::io_uring ? io_backend::io_uring : io_backend::sync;
+}
+#endif
+
+
+// The parallel converter needs the whole text in memory, so it always maps its input file
+[[nodiscard]] input_reader_up make_file_reader(const fs::path& file_path, const command_line_options& options) {
+#ifndef _WIN32
+    if (options.io != io_mode::mapped and options.jobs == 1) {
+        return std::make_unique<async_file_reader>(file_path, to_io_backend(options.io));
+    }
+#endif
+    return std::make_unique<mapped_file_reader>(file_path);
+}
+
+
+[[nodiscard]] output_writer_up make_file_writer(const fs::path& file_path, const command_line_options& options) {
+#ifndef _WIN32
+    if (options.io != io_mode::mapped) {
+        return std::make_unique<async_file_writer>(file_path, to_io_backend(options.io));
+    }
+#endif
+    return std::make_unique<file_writer>(file_path);
+}
 
-        // Create a reader and a list of writers
-        input_reader_up input_reader{ std::make_unique<file_reader>(options.input_file) };
-        std::vector<output_writer_up> output_writers{};
+
+void print_stats(std::ostream& es, const conversion_stats& stats, stats_format format) {
+    if (format == stats_format::json) {
+        fmt::print(es, "{}\n", to_json(stats));
+    } else {
+        fmt::print(es, "{}", stats);
+    }
+}
+
+
+void convert_file(std::istream& is, std::ostream& os, std::ostream& es, const command_line_options& options) {
+    // Statistics are only gathered if asked for, so that a conversion without them does not read any clock
+    using clock = std::chrono::steady_clock;
+    std::optional<conversion_stats> stats{};
+    if (options.stats) {
+        stats.emplace();
+    }
+    auto start{ stats ? clock::now() : clock::time_point{} };
+    auto start_cpu{ stats ? process_cpu_time() : std::chrono::nanoseconds{} };
+
+    // Spans are recorded, on every thread, while the trace recorder is alive, and written out once the output has been flushed
+    std::unique_ptr<file_writer> trace_writer{};
+    std::optional<trace_recorder> trace{};
+    if (options.trace_file) {
+        trace_writer = std::make_unique<file_writer>(options.trace_file.value());
+        trace.emplace();
+        WORD_CONVERTER_TRACE_THREAD("main");
+    }
+
+    // Create a reader and a list of writers
+    // The standard input is read sentence by sentence, so that every sentence is converted as soon as its period arrives
+    auto from_standard_input{ is_standard_stream(options.input_files.front()) };
+    auto to_standard_output_only{ options.output_file and is_standard_stream(options.output_file.value()) };
+    auto in_parallel{ options.jobs > 1 and not from_standard_input };
+    input_reader_up input_reader{};
+    if (from_standard_input) {
+        input_reader = std::make_unique<stream_reader>(is);
+    } else {
+        input_reader = make_file_reader(options.input_files.front(), options);
+    }
+    // Every read is timed, but for the parallel converter, which does not read its mapped input text, but only splits it
+    if (stats and in_parallel) {
+        stats->read.wall = clock::now() - start;
+        stats->read.bytes = static_cast<const mapped_file_reader&>(*input_reader).get_text().size();
+        stats->read.calls = 1;
+    } else if (stats) {
+        input_reader = std::make_unique<timed_reader>(std::move(input_reader), stats->read);
+    }
+    std::vector<output_writer_up> output_writers{};
+    auto to_output_file{ options.output_file and not to_standard_output_only };
+#ifndef _WIN32
+    // The standard output and the output file are written by a single writer, straight to their file descriptors,
+    // unless the output file is written on its own, keeping several writes in flight
+    if (&os == &std::cout) {
+        os.flush();
+        auto writer{ std::make_unique<multi_sink_writer>() };
+        writer->add_sink(STDOUT_FILENO);
+        if (to_output_file and options.io == io_mode::mapped) {
+            writer->add_sink(fs::path{ options.output_file.value() });
+            to_output_file = false;
+        }
+        output_writers.push_back(std::move(writer));
+    }
+#endif
+    if (output_writers.empty()) {
         output_writers.push_back(std::make_unique<stream_writer>(os));
-        if (options.output_file) {
-            output_writers.push_back(std::make_unique<file_writer>(options.output_file.value()));
+    }
+    if (to_output_file) {
+        output_writers.push_back(make_file_writer(options.output_file.value(), options));
+    }
+    // A downstream consumer of a filter gets every sentence as soon as it is converted, unless told otherwise
+    if (options.flush) {
+        std::ranges::for_each(output_writers, [&options](auto& writer) { writer->set_flush_policy(options.flush.value()); });
+    } else if (from_standard_input or to_standard_output_only) {
+        output_writers.front()->set_flush_policy({});
+    }
+    auto write_all = [&output_writers](std::string_view output_text) {
+        std::ranges::for_each(output_writers, [&output_text](auto& writer) { writer->write(output_text); });
+    };
+    std::optional<stage_timer> write_timer{};
+    if (stats) {
+        write_timer.emplace(stats->write);
+    }
+    auto write = [&write_all, &write_timer, &stats](std::string_view output_text) {
+        WORD_CONVERTER_TRACE_SPAN("write");
+        if (not stats) {
+            write_all(output_text);
+            return;
+        }
+        write_timer->time([&write_all, &output_text]() { write_all(output_text); });
+        stats->write.bytes += output_text.size();
+    };
+    // In recovery mode, malformed sentences are written out unchanged, and reported, one per line
+    std::unique_ptr<file_writer> error_report_writer{};
+    if (options.error_report_file) {
+        error_report_writer = std::make_unique<file_writer>(options.error_report_file.value());
+    }
+    auto report = [&error_report_writer](const sentence_error& error) {
+        error_report_writer->write(fmt::format("{}\n", error));
+    };
+
+    // Translate input text, and write out every sentence (or chunk of sentences) as soon as it is converted
+    // Output still buffered by the writers is written out at the end, so that write errors are reported
+    // The time spent converting is that not spent reading or writing on the converting thread,
+    // and that of the converting thread itself, when reads and writes run on threads of their own
+    auto convert_start{ stats ? clock::now() : clock::time_point{} };
+    if (in_parallel) {
+        auto text{ static_cast<const mapped_file_reader&>(*input_reader).get_text() };
+        parallel_converter converter{ options.jobs };
+        if (error_report_writer) {
+            converter.convert(text, write, report);
+        } else {
+            converter.convert(text, write);
+        }
+        if (stats) {
+            stats->convert.wall = clock::now() - convert_start - stats->write.wall;
+            stats->convert.cpu = converter.get_cpu_time();
+            stats->counters = converter.get_counters();
+        }
+    } else if (options.pipeline_block_size) {
+        pipeline_converter converter{ options.pipeline_block_size.value() };
+        if (error_report_writer) {
+            converter.convert(std::move(input_reader), write, report);
+        } else {
+            converter.convert(std::move(input_reader), write);
+        }
+        if (stats) {
+            auto cpu_times{ converter.get_cpu_times() };
+            stats->read.cpu = cpu_times.read;
+            stats->convert.wall = clock::now() - convert_start;
+            stats->convert.cpu = cpu_times.convert;
+            stats->write.cpu = cpu_times.write;
+            stats->counters = converter.get_counters();
+        }
+    } else {
+        auto t{ std::make_unique<translator>(std::move(input_reader)) };
+        if (error_report_writer) {
+            t->translate(write, report);
+        } else {
+            t->translate(write);
         }
+        if (stats) {
+            stats->convert.wall = clock::now() - convert_start - stats->read.wall - stats->write.wall;
+            stats->counters = t->get_counters();
+        }
+    }
+    auto flush_start{ stats ? clock::now() : clock::time_point{} };
+    {
+        WORD_CONVERTER_TRACE_SPAN("flush");
+        std::ranges::for_each(output_writers, [](auto& writer) { writer->flush(); });
+    }
+
+    if (stats) {
+        auto end{ clock::now() };
+        stats->write.wall += end - flush_start;
+        stats->convert.bytes = stats->read.bytes;
+        stats->convert.calls = stats->counters.sentences;
+        stats->wall = end - start;
+        stats->cpu = process_cpu_time() - start_cpu;
+        print_stats(es, stats.value(), options.stats.value());
+    }
+    if (trace) {
+        trace->write(*trace_writer);
+        trace_writer->flush();
+    }
+}
 
-        // Parse input text
-        const auto& output_text{ std::make_unique<parser>(std::move(input_reader))->parse() };
 
-        // Write out output text
-        std::ranges::for_each(output_writers, [&output_text](auto& writer) { writer->write(output_text); });
+// Returns the number of files that could not be converted
+[[nodiscard]] size_t convert_batch(std::ostream& os, const command_line_options& options) {
+    if (not options.output_file) {
+        throw missing_argument_error{ "-o" };
+    }
+    std::vector<fs::path> input_paths{ options.input_files.begin(), options.input_files.end() };
+    if (options.list_file) {
+        std::ranges::move(read_list_file(options.list_file.value()), std::back_inserter(input_paths));
+    }
+    auto jobs{ collect_batch_jobs(input_paths, options.output_file.value()) };
+    std::unique_ptr<file_writer> error_report_writer{};
+    if (options.error_report_file) {
+        error_report_writer = std::make_unique<file_writer>(options.error_report_file.value());
+    }
+    auto results{ batch_converter{ options.jobs, error_report_writer != nullptr }.convert(jobs) };
+
+    size_t errors{ 0 };
+    size_t sentence_errors{ 0 };
+    for (const auto& result : results) {
+        if (not result.ok()) {
+            fmt::print(os, "Error: '{}': {}\n", result.input_file.generic_string(), result.error);
+            ++errors;
+        }
+        for (const auto& recovered : result.sentence_errors) {
+            error_report_writer->write(fmt::format("'{}': {}\n", result.input_file.generic_string(), recovered));
+        }
+        sentence_errors += result.sentence_errors.size();
+    }
+    fmt::print(os, "Converted {} of {} files\n", results.size() - errors, results.size());
+    if (error_report_writer) {
+        fmt::print(os, "Copied {} malformed sentence(s) through\n", sentence_errors);
+    }
+    return errors;
+}
+
+
+#ifndef _WIN32
+// Server being run, stopped by SIGINT and SIGTERM
+// The signal handler may only read it if it is a lock-free atomic; stopping the server only writes to its self-pipe
+std::atomic<conversion_server*> running_server{ nullptr };
+static_assert(std::atomic<conversion_server*>::is_always_lock_free);
+
+extern "C" void stop_running_server(int) {
+    auto saved_errno{ errno };
+    if (auto server{ running_server.load() }) {
+        server->stop();
+    }
+    errno = saved_errno;
+}
+#endif
+
+
+// Serves conversion requests until interrupted
+void serve(std::ostream& os, const command_line_options& options) {
+#ifdef _WIN32
+    (void) os;
+    throw invalid_argument_error{ "--serve " + options.socket_file.value() };
+#else
+    conversion_server server{ options.socket_file.value() };
+    fmt::print(os, "Serving on '{}'\n", server.get_socket_path().generic_string());
+    os.flush();
+    running_server = &server;
+    std::signal(SIGINT, stop_running_server);
+    std::signal(SIGTERM, stop_running_server);
+    server.run();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    running_server = nullptr;
+#endif
+}
+
+
+int main_impl(std::istream& is, std::ostream& os, std::ostream& es, int argc, const char** argv) {
+    try {
+        // Parse command line options
+        auto options{ command_line_parser::parse(argc, argv) };
+
+        // Statistics and traces are only gathered for the conversion of a single input
+        if ((options.stats or options.trace_file) and (options.socket_file or is_batch(options))) {
+            throw invalid_argument_error{ options.stats ? "--stats" : "--trace" };
+        }
+#ifndef WORD_CONVERTER_TRACING
+        // Trace spans are not compiled in
+        if (options.trace_file) {
+            throw invalid_argument_error{ "--trace" };
+        }
+#endif
+        if (options.socket_file) {
+            serve(os, options);
+            return 0;
+        }
+        if (is_batch(options)) {
+            return convert_batch(os, options) == 0 ? 0 : -1;
+        }
+        convert_file(is, os, es, options);
     } catch (const std::exception& ex) {
         fmt::print(os, "Error: {}\n\n", ex.what());
         print_usage(os);
@@ -50,5 +393,9 @@ int main_impl(std::ostream& os, int argc, const char** argv) {
 
 
 int main(int argc, const char** argv) {
-    return main_impl(std::cout, argc, argv);
+    // Standard streams are not synchronized with C I/O, and reading from std::cin does not flush std::cout,
+    // so that the output is only flushed as told by the flush policy
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+    return main_impl(std::cin, std::cout, std::cerr, argc, argv);
 }
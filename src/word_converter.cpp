@@ -0,0 +1,111 @@
+#include "ast.h"  // invalid_number_expression_error
+#include "input_reader.h"  // memory_reader
+#include "parser.h"  // invalid_token_error
+#include "translator.h"
+#include "word_converter.h"
+
+#include <exception>
+#include <memory>  // make_unique, unique_ptr
+#include <new>  // bad_alloc, nothrow
+#include <string>
+#include <string_view>
+
+
+// A translator, reset for every conversion, and the buffers the results are returned in
+struct wc_context {
+    translator translator_{ std::make_unique<memory_reader>(std::string_view{}) };
+    std::string output_{};
+    std::string error_{};
+};
+
+
+namespace {
+    [[nodiscard]] wc_context& get_context(wc_context* context) {
+        thread_local std::unique_ptr<wc_context> thread_context{};
+        if (context) {
+            return *context;
+        }
+        if (not thread_context) {
+            thread_context = std::make_unique<wc_context>();
+        }
+        return *thread_context;
+    }
+
+    // Exceptions do not cross the C API, they are turned into a status and an error message
+    [[nodiscard]] wc_status convert(wc_context& context, std::string_view text) {
+        context.output_.clear();
+        context.error_.clear();
+        try {
+            context.translator_.reset(std::make_unique<memory_reader>(text));
+            context.translator_.translate_into(context.output_);
+            return WC_OK;
+        } catch (const invalid_token_error& ex) {
+            context.error_ = ex.what();
+            return WC_INVALID_TEXT;
+        } catch (const invalid_number_expression_error& ex) {
+            context.error_ = ex.what();
+            return WC_INVALID_TEXT;
+        } catch (const std::bad_alloc&) {
+            return WC_OUT_OF_MEMORY;
+        } catch (const std::exception& ex) {
+            context.error_ = ex.what();
+            return WC_ERROR;
+        }
+    }
+}  // namespace
+
+
+extern "C" {
+
+wc_context* wc_context_create(void) {
+    try {
+        return new wc_context{};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void wc_context_destroy(wc_context* context) {
+    delete context;
+}
+
+wc_status wc_convert(wc_context* context, const char* in, size_t len, wc_buffer* out) {
+    if (not out or (not in and len != 0)) {
+        return WC_INVALID_ARGUMENT;
+    }
+    *out = { nullptr, 0 };
+    wc_context* c{};
+    try {
+        c = &get_context(context);
+    } catch (...) {
+        return WC_OUT_OF_MEMORY;
+    }
+    auto status{ convert(*c, { in, len }) };
+    if (status == WC_OK) {
+        *out = { c->output_.data(), c->output_.size() };
+    } else {
+        c->output_.clear();
+    }
+    return status;
+}
+
+const char* wc_last_error(const wc_context* context) {
+    try {
+        return get_context(const_cast<wc_context*>(context)).error_.c_str();
+    } catch (...) {
+        return "";
+    }
+}
+
+const char* wc_status_name(wc_status status) {
+    switch (status) {
+        case WC_OK: return "WC_OK";
+        case WC_INVALID_ARGUMENT: return "WC_INVALID_ARGUMENT";
+        case WC_INVALID_TEXT: return "WC_INVALID_TEXT";
+        case WC_OUT_OF_MEMORY: return "WC_OUT_OF_MEMORY";
+        case WC_ERROR: return "WC_ERROR";
+    }
+    return "unknown status";
+}
+
+}  // extern "C"
@@ -0,0 +1,54 @@
+#include "allocation_counter.h"
+
+#include <cstdlib>  // free, malloc
+#include <new>  // bad_alloc, nothrow_t
+
+
+namespace allocation_counter {
+    std::atomic<bool> enabled{ false };
+    std::atomic<size_t> count{ 0 };
+
+    [[nodiscard]] void* allocate(std::size_t size) noexcept {
+        if (enabled) {
+            ++count;
+        }
+        return std::malloc(size == 0 ? 1 : size);
+    }
+}  // namespace allocation_counter
+
+
+// Replacements of the global allocation functions
+// Aligned versions are not replaced; they keep pairing with their own deallocation functions
+void* operator new(std::size_t size) {
+    if (auto p{ allocation_counter::allocate(size) }) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocation_counter::allocate(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocation_counter::allocate(size);
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>  // size_t
+
+
+// Counts the allocations done through the global operator new while counting is enabled
+// The test binary replaces the global allocation functions to that end
+namespace allocation_counter {
+    extern std::atomic<bool> enabled;
+    extern std::atomic<size_t> count;
+
+    template <typename F>
+    [[nodiscard]] size_t count_allocations(F&& f) {
+        count = 0;
+        enabled = true;
+        f();
+        enabled = false;
+        return count;
+    }
+}  // namespace allocation_counter
@@ -1,3 +1,160 @@
+#include "ast.h"
+#include "output_writer.h"
+
+#include <cstdint>  // int64_t
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <limits>  // numeric_limits
+#include <sstream>  // ostringstream
+#include <string>
+
+
+namespace {
+    // one hundred and twenty-three
+    ast::number_expression_node make_number_expression_node(std::string_view trailing_text) {
+        ast::number_expression_node ret{};
+        ret.add(ast::int_node{ 1 });
+        ret.add(ast::text_node{ " " });
+        ret.add(ast::int_node{ 100 });
+        ret.add(ast::text_node{ " and " });
+        ret.add(ast::int_node{ 20 });
+        ret.add(ast::text_node{ "-" });
+        ret.add(ast::int_node{ 3 });
+        if (not trailing_text.empty()) {
+            ret.add(ast::text_node{ trailing_text });
+        }
+        return ret;
+    }
+
+    // foo one hundred and twenty-three.
+    ast::sentence_node make_sentence_node() {
+        ast::sentence_node ret{};
+        ret.add(ast::text_node{ "foo " });
+        ret.add(make_number_expression_node(""));
+        ret.add(ast::text_node{ "." });
+        return ret;
+    }
+}  // namespace
+
+
+TEST(append_number, int_limits) {
+    std::string output{ "#" };
+    ast::append_number(output, std::numeric_limits<int>::min());
+    ast::append_number(output, std::numeric_limits<int>::max());
+    EXPECT_EQ(output, fmt::format("#{}{}", std::numeric_limits<int>::min(), std::numeric_limits<int>::max()));
+}
+
+TEST(append_number, int64_limits) {
+    std::string output{ "#" };
+    ast::append_number(output, std::numeric_limits<int64_t>::min());
+    ast::append_number(output, std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(output, fmt::format("#{}{}", std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()));
+}
+
+// nine hundred and ninety-nine billion, and one thousand and one
+TEST(number_expression_stack, value_is_updated_with_every_push) {
+    number_expression_stack stack{};
+    for (int64_t number : { 9, 100, 90, 9, 1'000'000'000 }) {
+        stack.push(number);
+    }
+    EXPECT_EQ(stack.value(), 999'000'000'000);
+    stack.push(1);
+    EXPECT_EQ(stack.value(), 999'000'000'001);
+    stack.clear();
+    for (int64_t number : { 1, 1'000, 1 }) {
+        stack.push(number);
+    }
+    EXPECT_EQ(stack.value(), 1'001);
+}
+TEST(number_expression_stack, same_number_twice) {
+    number_expression_stack stack{};
+    stack.push(9);
+    EXPECT_THROW(stack.push(9), invalid_number_expression_error);
+}
+TEST(number_expression_stack, more_numbers_than_capacity) {
+    number_expression_stack stack{};
+    for (auto i{ static_cast<int64_t>(number_expression_stack::capacity) }; i > 0; --i) {
+        stack.push(i);
+    }
+    EXPECT_THROW(stack.push(0), invalid_number_expression_error);
+}
+TEST(number_expression_stack, try_push_returns_the_error) {
+    number_expression_stack stack{};
+    ASSERT_TRUE(stack.try_push(100));
+    auto result{ stack.try_push(100) };
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error(), "100 100");
+    EXPECT_EQ(stack.value(), 100);
+}
+
+TEST(text_node, evaluate_into) {
+    std::string output{ "#" };
+    ast::text_node{ "foo" }.evaluate_into(output);
+    EXPECT_EQ(output, "#foo");
+}
+TEST(int_node, evaluate_into) {
+    std::string output{ "#" };
+    ast::int_node{ 20 }.evaluate_into(output);
+    EXPECT_EQ(output, "#20");
+}
+TEST(int_node, dump_into) {
+    std::string output{ "#" };
+    ast::int_node{ 20 }.dump_into(output);
+    EXPECT_EQ(output, "#twenty");
+}
+
+TEST(number_expression_node, evaluate_into_empty_node) {
+    std::string output{ "#" };
+    ast::number_expression_node{}.evaluate_into(output);
+    EXPECT_EQ(output, "#");
+}
+TEST(number_expression_node, evaluate_into) {
+    std::string output{ "#" };
+    make_number_expression_node(" ").evaluate_into(output);
+    EXPECT_EQ(output, "#123 ");
+}
+TEST(number_expression_node, dump_into) {
+    std::string output{ "#" };
+    make_number_expression_node(" ").dump_into(output);
+    EXPECT_EQ(output, "#one hundred and twenty-three ");
+}
+
+TEST(sentence_node, evaluate_into) {
+    std::string output{ "#" };
+    make_sentence_node().evaluate_into(output);
+    EXPECT_EQ(output, "#foo 123.");
+}
+TEST(sentence_node, evaluate_equals_evaluate_into) {
+    std::string output{};
+    auto node{ make_sentence_node() };
+    node.evaluate_into(output);
+    EXPECT_EQ(node.evaluate(), output);
+    EXPECT_EQ(node.dump(), "foo one hundred and twenty-three.");
+}
 
+TEST(tree, evaluate_into) {
+    ast::tree tree{};
+    tree.add(make_sentence_node());
+    tree.add(make_sentence_node());
+    std::string output{};
+    tree.evaluate_into(output);
+    EXPECT_EQ(output, "foo 123.foo 123.");
+    EXPECT_EQ(tree.evaluate(), output);
+}
+TEST(tree, evaluate_into_output_writer) {
+    ast::tree tree{};
+    tree.add(make_sentence_node());
+    std::ostringstream oss{};
+    stream_writer writer{ oss };
+    tree.evaluate_into(writer);
+    EXPECT_EQ(oss.str(), "foo 123.");
+}
+TEST(tree, dump_into) {
+    ast::tree tree{};
+    tree.add(make_sentence_node());
+    tree.add(make_sentence_node());
+    std::string output{};
+    tree.dump_into(output);
+    EXPECT_EQ(output, "foo one hundred and twenty-three.foo one hundred and twenty-three.");
+    EXPECT_EQ(tree.dump(), output);
+}
@@ -0,0 +1,202 @@
+#include "batch_converter.h"
+#include "read_file.h"
+#include "temporary_path.h"
+
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>  // geteuid
+#endif
+
+namespace fs = std::filesystem;
+
+
+namespace {
+    void write_file(const fs::path& file_path, const std::string& text) {
+        fs::create_directories(file_path.parent_path());
+        std::ofstream ofs{ file_path };
+        ofs << text;
+    }
+
+    // Creates an empty temporary directory, and removes it at the end of the test
+    class batch_converter_test : public ::testing::Test {
+    protected:
+        temporary_path temp_dir{ fmt::format("batch_converter_{}", ::testing::UnitTest::GetInstance()->current_test_info()->name()) };
+
+        void SetUp() override {
+            fs::create_directories(temp_dir);
+        }
+    };
+}  // namespace
+
+
+// Mirror path
+TEST(mirror_path, file_in_input_dir) {
+    EXPECT_EQ(mirror_path("in/a/b.txt", "in", "out"), fs::path{ "out/a/b.txt" });
+}
+TEST(mirror_path, relative_file) {
+    EXPECT_EQ(mirror_path("a/./b.txt", {}, "out"), fs::path{ "out/a/b.txt" });
+}
+TEST(mirror_path, file_outside_current_dir) {
+    EXPECT_EQ(mirror_path("../a/b.txt", {}, "out"), fs::path{ "out/b.txt" });
+}
+TEST(mirror_path, absolute_file) {
+    EXPECT_EQ(mirror_path(fs::temp_directory_path() / "a" / "b.txt", {}, "out"), fs::path{ "out/b.txt" });
+}
+
+
+// Read list file
+TEST_F(batch_converter_test, read_list_file) {
+    write_file(temp_dir / "list.txt", "a.txt\n\nb/c.txt\r\n");
+    EXPECT_EQ(read_list_file(temp_dir / "list.txt"), (std::vector<fs::path>{ "a.txt", "b/c.txt" }));
+}
+TEST_F(batch_converter_test, read_list_file_that_does_not_exist) {
+    EXPECT_THROW((void) read_list_file(temp_dir / "list.txt"), file_is_not_a_regular_file_error);
+}
+
+
+// Collect batch jobs
+TEST_F(batch_converter_test, collect_batch_jobs) {
+    write_file(temp_dir / "in" / "b.txt", "");
+    write_file(temp_dir / "in" / "a" / "c.txt", "");
+    auto jobs{ collect_batch_jobs({ temp_dir / "in", "d.txt" }, "out") };
+    ASSERT_EQ(jobs.size(), 3);
+    EXPECT_EQ(jobs[0].input_file, temp_dir / "in" / "a" / "c.txt");
+    EXPECT_EQ(jobs[0].output_file, fs::path{ "out/a/c.txt" });
+    EXPECT_EQ(jobs[1].input_file, temp_dir / "in" / "b.txt");
+    EXPECT_EQ(jobs[1].output_file, fs::path{ "out/b.txt" });
+    EXPECT_EQ(jobs[2].input_file, fs::path{ "d.txt" });
+    EXPECT_EQ(jobs[2].output_file, fs::path{ "out/d.txt" });
+    for (const auto& job : jobs) {
+        EXPECT_TRUE(job.error.empty()) << job.error;
+    }
+}
+TEST_F(batch_converter_test, collect_batch_jobs_with_the_same_output_file) {
+    write_file(temp_dir / "a" / "x.txt", "");
+    write_file(temp_dir / "b" / "x.txt", "");
+    auto jobs{ collect_batch_jobs({ temp_dir / "a" / "x.txt", temp_dir / "b" / "x.txt" }, temp_dir / "out") };
+    ASSERT_EQ(jobs.size(), 2);
+    EXPECT_TRUE(jobs[0].error.empty());
+    EXPECT_EQ(jobs[1].error, duplicate_output_file_error{ temp_dir / "out" / "x.txt" }.what());
+}
+TEST_F(batch_converter_test, collect_batch_jobs_with_an_output_file_that_is_an_input_file) {
+    write_file(temp_dir / "in" / "a.txt", "");
+    write_file(temp_dir / "in" / "b" / "a.txt", "");
+    auto jobs{ collect_batch_jobs({ temp_dir / "in" }, temp_dir / "in" / "b") };
+    ASSERT_EQ(jobs.size(), 2);
+    EXPECT_EQ(jobs[0].input_file, temp_dir / "in" / "a.txt");
+    EXPECT_EQ(jobs[0].error, output_file_is_an_input_file_error{ temp_dir / "in" / "b" / "a.txt" }.what());
+    EXPECT_EQ(jobs[1].input_file, temp_dir / "in" / "b" / "a.txt");
+    EXPECT_TRUE(jobs[1].error.empty());
+}
+
+
+// Convert
+TEST_F(batch_converter_test, convert) {
+    write_file(temp_dir / "in" / "a.txt", "one. foo two.three");
+    write_file(temp_dir / "in" / "b" / "c.txt", "Twenty-one thousand and five.");
+    write_file(temp_dir / "in" / "d.txt", "");
+    auto jobs{ collect_batch_jobs({ temp_dir / "in" }, temp_dir / "out") };
+    auto results{ batch_converter{ 2 }.convert(jobs) };
+    ASSERT_EQ(results.size(), 3);
+    for (const auto& result : results) {
+        EXPECT_TRUE(result.ok()) << result.error;
+    }
+    EXPECT_EQ(read_file(temp_dir / "out" / "a.txt"), "1. foo 2.3");
+    EXPECT_EQ(read_file(temp_dir / "out" / "b" / "c.txt"), "21005.");
+    EXPECT_TRUE(fs::exists(temp_dir / "out" / "d.txt"));
+    EXPECT_EQ(read_file(temp_dir / "out" / "d.txt"), "");
+}
+TEST_F(batch_converter_test, convert_with_errors) {
+    write_file(temp_dir / "in" / "a.txt", "one. one two.");
+    write_file(temp_dir / "in" / "b.txt", "two.");
+    auto jobs{ collect_batch_jobs({ temp_dir / "in", temp_dir / "missing.txt" }, temp_dir / "out") };
+    auto results{ batch_converter{ 4 }.convert(jobs) };
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(results[0].input_file, temp_dir / "in" / "a.txt");
+    EXPECT_FALSE(results[0].ok());
+    EXPECT_TRUE(results[1].ok());
+    EXPECT_EQ(read_file(temp_dir / "out" / "b.txt"), "2.");
+    EXPECT_EQ(results[2].input_file, temp_dir / "missing.txt");
+    EXPECT_FALSE(results[2].ok());
+}
+TEST_F(batch_converter_test, convert_removes_the_output_file_of_a_failing_file) {
+    write_file(temp_dir / "in" / "a.txt", "one. one two.");
+    auto results{ batch_converter{ 1 }.convert(collect_batch_jobs({ temp_dir / "in" }, temp_dir / "out")) };
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_FALSE(results[0].ok());
+    EXPECT_FALSE(fs::exists(temp_dir / "out" / "a.txt"));
+}
+TEST_F(batch_converter_test, convert_does_not_overwrite_an_input_file) {
+    write_file(temp_dir / "a.txt", "one.");
+    write_file(temp_dir / "b.txt", "two.");
+    auto results{ batch_converter{ 2 }.convert(collect_batch_jobs({ temp_dir / "a.txt", temp_dir / "b.txt" }, temp_dir)) };
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(results[0].error, output_file_is_an_input_file_error{ temp_dir / "a.txt" }.what());
+    EXPECT_FALSE(results[1].ok());
+    EXPECT_EQ(read_file(temp_dir / "a.txt"), "one.");
+    EXPECT_EQ(read_file(temp_dir / "b.txt"), "two.");
+}
+TEST_F(batch_converter_test, convert_does_not_overwrite_a_hard_link_to_its_input_file) {
+    write_file(temp_dir / "in" / "a.txt", "one.");
+    fs::create_directories(temp_dir / "out");
+    fs::create_hard_link(temp_dir / "in" / "a.txt", temp_dir / "out" / "a.txt");
+    auto results{ batch_converter{ 1 }.convert(collect_batch_jobs({ temp_dir / "in" }, temp_dir / "out")) };
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].error, output_file_is_an_input_file_error{ temp_dir / "out" / "a.txt" }.what());
+    EXPECT_EQ(read_file(temp_dir / "in" / "a.txt"), "one.");
+}
+TEST_F(batch_converter_test, convert_with_the_same_output_file) {
+    write_file(temp_dir / "a" / "x.txt", "one.");
+    write_file(temp_dir / "b" / "x.txt", "two.");
+    auto jobs{ collect_batch_jobs({ temp_dir / "a" / "x.txt", temp_dir / "b" / "x.txt" }, temp_dir / "out") };
+    auto results{ batch_converter{ 2 }.convert(jobs) };
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_TRUE(results[0].ok());
+    EXPECT_FALSE(results[1].ok());
+    EXPECT_EQ(read_file(temp_dir / "out" / "x.txt"), "1.");
+}
+#ifndef _WIN32
+TEST_F(batch_converter_test, convert_with_an_unreadable_directory) {
+    if (::geteuid() == 0) {
+        GTEST_SKIP() << "permissions are not enforced for root";
+    }
+    write_file(temp_dir / "in" / "a.txt", "one.");
+    write_file(temp_dir / "in" / "b" / "c.txt", "two.");
+    fs::permissions(temp_dir / "in" / "b", fs::perms::none);
+    auto jobs{ collect_batch_jobs({ temp_dir / "in" }, temp_dir / "out") };
+    auto results{ batch_converter{ 2 }.convert(jobs) };
+    fs::permissions(temp_dir / "in" / "b", fs::perms::owner_all);
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_TRUE(results[0].ok());
+    EXPECT_EQ(results[1].input_file, temp_dir / "in" / "b");
+    EXPECT_EQ(results[1].error, could_not_read_directory_error{ temp_dir / "in" / "b" }.what());
+    EXPECT_EQ(read_file(temp_dir / "out" / "a.txt"), "1.");
+}
+#endif
+TEST_F(batch_converter_test, convert_with_recovery) {
+    write_file(temp_dir / "in" / "a.txt", "one. one two. three.");
+    write_file(temp_dir / "in" / "b.txt", "two.");
+    auto jobs{ collect_batch_jobs({ temp_dir / "in" }, temp_dir / "out") };
+    auto results{ batch_converter{ 2, true }.convert(jobs) };
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_TRUE(results[0].ok() and results[1].ok());
+    EXPECT_EQ(read_file(temp_dir / "out" / "a.txt"), "1. one two. 3.");
+    ASSERT_EQ(results[0].sentence_errors.size(), 1);
+    EXPECT_EQ(results[0].sentence_errors[0].offset, 4);
+    EXPECT_EQ(results[0].sentence_errors[0].sentence, " one two.");
+    EXPECT_TRUE(results[1].sentence_errors.empty());
+}
+TEST_F(batch_converter_test, in_1_txt_and_in_2_txt) {
+    auto jobs{ collect_batch_jobs({ "../../res/in_1.txt", "../../res/in_2.txt" }, temp_dir) };
+    auto results{ batch_converter{ 2 }.convert(jobs) };
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_TRUE(results[0].ok() and results[1].ok());
+    EXPECT_EQ(read_file(temp_dir / "in_1.txt"), read_file("../../res/out_1.txt"));
+    EXPECT_EQ(read_file(temp_dir / "in_2.txt"), read_file("../../res/out_2.txt"));
+}
@@ -2,6 +2,8 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <string>
+#include <vector>
 
 
 TEST(command_line_parser_parse, argc_equals_1) {
@@ -45,19 +47,166 @@ TEST(command_line_parser_parse, argc_equals_3_and_valid_argv) {
     int argc{ 3 };
     const char* argv[] = { "word_converter", "-i", "in.txt" };
     auto options{ command_line_parser::parse(argc, argv) };
-    EXPECT_EQ(options.input_file, "in.txt");
+    EXPECT_EQ(options.input_files, std::vector<std::string>{ "in.txt" });
 }
 TEST(command_line_parser_parse, argc_equals_5_and_valid_argv) {
     int argc{ 5 };
     const char* argv[] = { "word_converter", "-i", "in.txt", "-o", "out.txt" };
     auto options{ command_line_parser::parse(argc, argv) };
-    EXPECT_EQ(options.input_file, "in.txt");
+    EXPECT_EQ(options.input_files, std::vector<std::string>{ "in.txt" });
     EXPECT_EQ(options.output_file, "out.txt");
 }
 TEST(command_line_parser_parse, argc_equals_5_and_valid_argv_in_reverse_order) {
     int argc{ 5 };
     const char* argv[] = { "word_converter", "-o", "out.txt", "-i", "in.txt" };
     auto options{ command_line_parser::parse(argc, argv) };
-    EXPECT_EQ(options.input_file, "in.txt");
+    EXPECT_EQ(options.input_files, std::vector<std::string>{ "in.txt" });
     EXPECT_EQ(options.output_file, "out.txt");
 }
+
+TEST(command_line_parser_parse, missing_input_file) {
+    int argc{ 3 };
+    const char* argv[] = { "word_converter", "-j", "4" };
+    EXPECT_THROW((void) command_line_parser::parse(argc, argv), missing_argument_error);
+}
+TEST(command_line_parser_parse, jobs_default_to_1) {
+    int argc{ 3 };
+    const char* argv[] = { "word_converter", "-i", "in.txt" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.jobs, 1);
+}
+TEST(command_line_parser_parse, jobs) {
+    int argc{ 7 };
+    const char* argv[] = { "word_converter", "-j", "8", "-i", "in.txt", "-o", "out.txt" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.input_files, std::vector<std::string>{ "in.txt" });
+    EXPECT_EQ(options.output_file, "out.txt");
+    EXPECT_EQ(options.jobs, 8);
+}
+TEST(command_line_parser_parse, jobs_equals_0) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "in.txt", "-j", "0" };
+    EXPECT_THROW((void) command_line_parser::parse(argc, argv), invalid_argument_error);
+}
+TEST(command_line_parser_parse, jobs_is_not_a_number) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "in.txt", "-j", "4x" };
+    EXPECT_THROW((void) command_line_parser::parse(argc, argv), invalid_argument_error);
+}
+TEST(command_line_parser_parse, many_input_files) {
+    int argc{ 7 };
+    const char* argv[] = { "word_converter", "-i", "in_1.txt", "-i", "in_dir", "-o", "out_dir" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.input_files, (std::vector<std::string>{ "in_1.txt", "in_dir" }));
+    EXPECT_FALSE(options.list_file);
+    EXPECT_EQ(options.output_file, "out_dir");
+}
+TEST(command_line_parser_parse, list_file) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-l", "list.txt", "-o", "out_dir" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_TRUE(options.input_files.empty());
+    EXPECT_EQ(options.list_file, "list.txt");
+    EXPECT_EQ(options.output_file, "out_dir");
+}
+
+TEST(command_line_parser_parse, standard_input_and_output) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "-", "-o", "-" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.input_files, std::vector<std::string>{ "-" });
+    EXPECT_EQ(options.output_file, "-");
+    EXPECT_FALSE(options.flush);
+}
+TEST(command_line_parser_parse, flush_every_sentence) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "-", "-f", "sentence" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.flush, flush_policy{});
+}
+TEST(command_line_parser_parse, flush_bytes) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "-", "-f", "64K" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.flush, (flush_policy{ .bytes = 64 * 1024 }));
+}
+TEST(command_line_parser_parse, flush_bytes_and_interval) {
+    int argc{ 7 };
+    const char* argv[] = { "word_converter", "-i", "-", "-f", "4096", "-f", "20ms" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.flush, (flush_policy{ .bytes = 4096, .interval = std::chrono::milliseconds{ 20 } }));
+}
+TEST(command_line_parser_parse, flush_is_not_valid) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "-", "-f", "often" };
+    EXPECT_THROW((void) command_line_parser::parse(argc, argv), invalid_argument_error);
+}
+TEST(command_line_parser_parse, serve) {
+    int argc{ 3 };
+    const char* argv[] = { "word_converter", "--serve", "/tmp/word_converter.sock" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_TRUE(options.input_files.empty());
+    EXPECT_EQ(options.socket_file, "/tmp/word_converter.sock");
+}
+TEST(command_line_parser_parse, recover) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "in.txt", "--recover", "errors.txt" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.error_report_file, "errors.txt");
+}
+TEST(command_line_parser_parse, io) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "in.txt", "--io", "uring" };
+    EXPECT_EQ(command_line_parser::parse(argc, argv).io, io_mode::io_uring);
+    argv[4] = "read";
+    EXPECT_EQ(command_line_parser::parse(argc, argv).io, io_mode::read);
+    argv[4] = "mmap";
+    EXPECT_EQ(command_line_parser::parse(argc, argv).io, io_mode::mapped);
+    EXPECT_EQ(command_line_parser::parse(3, argv).io, io_mode::mapped);
+}
+TEST(command_line_parser_parse, io_is_not_valid) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "in.txt", "--io", "aio" };
+    EXPECT_THROW((void) command_line_parser::parse(argc, argv), invalid_argument_error);
+}
+TEST(command_line_parser_parse, pipeline) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "-", "--pipeline", "64K" };
+    EXPECT_EQ(command_line_parser::parse(argc, argv).pipeline_block_size, 64 * 1024);
+    EXPECT_FALSE(command_line_parser::parse(3, argv).pipeline_block_size);
+}
+TEST(command_line_parser_parse, pipeline_block_size_is_not_valid) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "-", "--pipeline", "0" };
+    EXPECT_THROW((void) command_line_parser::parse(argc, argv), invalid_argument_error);
+    argv[4] = "big";
+    EXPECT_THROW((void) command_line_parser::parse(argc, argv), invalid_argument_error);
+}
+TEST(command_line_parser_parse, stats) {
+    int argc{ 4 };
+    const char* argv[] = { "word_converter", "--stats", "-i", "-" };
+    EXPECT_EQ(command_line_parser::parse(argc, argv).stats, stats_format::text);
+    argv[1] = "--stats=json";
+    EXPECT_EQ(command_line_parser::parse(argc, argv).stats, stats_format::json);
+    argv[1] = "--stats=text";
+    EXPECT_EQ(command_line_parser::parse(argc, argv).stats, stats_format::text);
+}
+TEST(command_line_parser_parse, stats_takes_no_value) {
+    int argc{ 6 };
+    const char* argv[] = { "word_converter", "-i", "in.txt", "--stats", "-o", "out.txt" };
+    auto options{ command_line_parser::parse(argc, argv) };
+    EXPECT_EQ(options.stats, stats_format::text);
+    EXPECT_EQ(options.output_file, "out.txt");
+    EXPECT_FALSE(command_line_parser::parse(3, argv).stats);
+}
+TEST(command_line_parser_parse, stats_format_is_not_valid) {
+    int argc{ 4 };
+    const char* argv[] = { "word_converter", "-i", "in.txt", "--stats=xml" };
+    EXPECT_THROW((void) command_line_parser::parse(argc, argv), invalid_argument_error);
+}
+TEST(command_line_parser_parse, trace) {
+    int argc{ 5 };
+    const char* argv[] = { "word_converter", "-i", "in.txt", "--trace", "trace.json" };
+    EXPECT_EQ(command_line_parser::parse(argc, argv).trace_file, "trace.json");
+    EXPECT_FALSE(command_line_parser::parse(3, argv).trace_file);
+}
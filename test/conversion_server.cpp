@@ -0,0 +1,135 @@
+#ifndef _WIN32
+
+#include "conversion_server.h"
+#include "corpus_generator.h"
+#include "temporary_path.h"
+
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>  // jthread
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+    // Runs a conversion server on a temporary socket, and stops it at the end of the test
+    class conversion_server_test : public ::testing::Test {
+    protected:
+        temporary_path socket_path{ "conversion_server" };
+        std::unique_ptr<conversion_server> server{};
+        std::jthread server_thread{};
+
+        void SetUp() override {
+            server = std::make_unique<conversion_server>(socket_path);
+            server_thread = std::jthread{ [this]() { server->run(); } };
+        }
+        void TearDown() override {
+            if (server_thread.joinable()) {
+                server->stop();
+                server_thread.join();
+            }
+            server.reset();
+        }
+    };
+}  // namespace
+
+
+TEST(conversion_protocol, encode_and_decode_length) {
+    using namespace conversion_protocol;
+    EXPECT_EQ(encode_length(0x01020304), (length_t{ 1, 2, 3, 4 }));
+    EXPECT_EQ(decode_length(encode_length(0)), 0);
+    EXPECT_EQ(decode_length(encode_length(0xFFFF'FFFF)), 0xFFFF'FFFF);
+    EXPECT_EQ(decode_length(encode_length(1'234'567)), 1'234'567);
+}
+
+TEST(conversion_server_constructor, socket_path_too_long) {
+    EXPECT_THROW(conversion_server{ fs::temp_directory_path() / std::string(200, 'a') }, socket_error);
+}
+TEST(conversion_server_constructor, stale_socket_file_is_replaced) {
+    temporary_path socket_path{ "stale_socket" };
+    {
+        // Bound, but never listened on, and closed without being removed, as if its server had been killed
+        file_descriptor socket{ ::socket(AF_UNIX, SOCK_STREAM, 0) };
+        auto address{ socket_io::make_address(socket_path, "bind") };
+        ASSERT_EQ(::bind(socket.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+    }
+    ASSERT_TRUE(fs::is_socket(socket_path));
+    conversion_server server{ socket_path };
+    std::jthread server_thread{ [&server]() { server.run(); } };
+    EXPECT_EQ(conversion_client{ socket_path }.convert("one."), "1.");
+    server.stop();
+}
+TEST(conversion_client_constructor, no_server) {
+    EXPECT_THROW(conversion_client{ fs::temp_directory_path() / "word_converter_no_server.sock" }, socket_error);
+}
+
+TEST_F(conversion_server_test, convert) {
+    conversion_client client{ socket_path };
+    EXPECT_EQ(client.convert("I have twenty-one apples. And one hundred and five pears.\n"), "I have 21 apples. And 105 pears.\n");
+}
+TEST_F(conversion_server_test, empty_request) {
+    conversion_client client{ socket_path };
+    EXPECT_EQ(client.convert(""), "");
+}
+TEST_F(conversion_server_test, many_requests_over_one_connection) {
+    conversion_client client{ socket_path };
+    EXPECT_EQ(client.convert("one."), "1.");
+    EXPECT_EQ(client.convert(" two and"), " 2 and");
+    EXPECT_EQ(client.convert("one thousand"), "1000");
+}
+TEST_F(conversion_server_test, malformed_request_does_not_close_the_connection) {
+    conversion_client client{ socket_path };
+    try {
+        (void) client.convert("one two.");
+        FAIL() << "expected a conversion request error";
+    } catch (const conversion_request_error& ex) {
+        EXPECT_EQ(std::string{ ex.what() }, "conversion request failed: invalid token: '(two_to_nine, 'two')', while parsing node: '1 '");
+    }
+    EXPECT_EQ(client.convert("three."), "3.");
+}
+TEST_F(conversion_server_test, concurrent_clients) {
+    static constexpr int clients{ 8 };
+    std::vector<std::string> inputs(clients);
+    std::vector<std::string> expected_outputs(clients);
+    std::vector<std::string> outputs(clients);
+    for (int i{ 0 }; i < clients; ++i) {
+        corpus_generator{ { .seed = static_cast<uint64_t>(i), .number_percent = 50 } }.generate(16 * 1024, inputs[i], expected_outputs[i]);
+    }
+    {
+        std::vector<std::jthread> threads{};
+        for (int i{ 0 }; i < clients; ++i) {
+            threads.emplace_back([this, &inputs, &outputs, i]() {
+                conversion_client client{ socket_path };
+                for (int j{ 0 }; j < 10; ++j) {
+                    outputs[i] = client.convert(inputs[i]);
+                }
+            });
+        }
+    }
+    EXPECT_EQ(outputs, expected_outputs);
+}
+TEST_F(conversion_server_test, socket_of_a_running_server_is_not_replaced) {
+    EXPECT_THROW(conversion_server{ socket_path }, socket_error);
+    conversion_client client{ socket_path };
+    EXPECT_EQ(client.convert("one."), "1.");
+}
+TEST_F(conversion_server_test, stop_closes_open_connections) {
+    conversion_client client{ socket_path };
+    EXPECT_EQ(client.convert("one."), "1.");
+    server->stop();
+    server_thread.join();
+    EXPECT_THROW((void) client.convert("two."), socket_error);
+}
+
+TEST(conversion_server_destructor, removes_socket_file) {
+    temporary_path socket_path{ "removed_socket" };
+    {
+        conversion_server server{ socket_path };
+        EXPECT_TRUE(fs::is_socket(socket_path));
+    }
+    EXPECT_FALSE(fs::exists(socket_path));
+}
+
+#endif  // _WIN32
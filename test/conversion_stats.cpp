@@ -0,0 +1,99 @@
+#include "conversion_stats.h"
+#include "input_reader.h"
+
+#include <chrono>
+#include <fmt/format.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory>  // make_unique
+#include <string>
+#include <string_view>
+#include <thread>  // sleep_for
+
+using namespace std::chrono_literals;
+
+
+namespace {
+    conversion_stats make_stats() {
+        conversion_stats ret{};
+        ret.read = { 2ms, std::nullopt, 1000, 10 };
+        ret.convert = { 4ms, 3ms, 1000, 5 };
+        ret.write = { 1ms, std::nullopt, 900, 5 };
+        ret.counters = { 5, 40, 7 };
+        ret.wall = 8ms;
+        ret.cpu = 6ms;
+        return ret;
+    }
+}  // namespace
+
+
+TEST(cpu_time, is_monotonic) {
+    auto thread_start{ thread_cpu_time() };
+    auto process_start{ process_cpu_time() };
+    volatile size_t n{ 0 };
+    for (size_t i{ 0 }; i < 1'000'000; ++i) {
+        n = n + i;
+    }
+    EXPECT_GE(thread_cpu_time(), thread_start);
+    EXPECT_GE(process_cpu_time(), process_start);
+    EXPECT_GE(process_cpu_time(), thread_cpu_time());
+}
+
+
+TEST(stage_stats_get_throughput, no_time_spent) {
+    EXPECT_FALSE((stage_stats{ 0ns, std::nullopt, 1000, 1 }.get_throughput()));
+}
+TEST(stage_stats_get_throughput, megabytes_per_second) {
+    EXPECT_DOUBLE_EQ((stage_stats{ 2ms, std::nullopt, 1000, 1 }.get_throughput().value()), 0.5);
+}
+
+
+TEST(conversion_stats_to_json, all_fields) {
+    EXPECT_EQ(to_json(make_stats()),
+        R"({"wall_ns":8000000,"cpu_ns":6000000,"stages":{)"
+        R"("read":{"wall_ns":2000000,"cpu_ns":null,"bytes":1000,"calls":10},)"
+        R"("convert":{"wall_ns":4000000,"cpu_ns":3000000,"bytes":1000,"calls":5},)"
+        R"("write":{"wall_ns":1000000,"cpu_ns":null,"bytes":900,"calls":5}},)"
+        R"("sentences":5,"tokens":40,"number_expressions":7})");
+}
+TEST(conversion_stats_format, one_line_per_stage) {
+    auto text{ fmt::format("{}", make_stats()) };
+    EXPECT_THAT(text, ::testing::ContainsRegex("read +2\\.000 +- +1000 +10 +0\\.5\n"));
+    EXPECT_THAT(text, ::testing::ContainsRegex("convert +4\\.000 +3\\.000 +1000 +5 +0\\.2\n"));
+    EXPECT_THAT(text, ::testing::ContainsRegex("write +1\\.000 +- +900 +5 +0\\.9\n"));
+    EXPECT_THAT(text, ::testing::ContainsRegex("total +8\\.000 +6\\.000\n"));
+    EXPECT_THAT(text, ::testing::HasSubstr("sentences: 5, tokens: 40, number expressions: 7\n"));
+}
+
+
+TEST(stage_timer, counts_and_times_every_call) {
+    stage_stats stats{};
+    stage_timer timer{ stats };
+    EXPECT_EQ(timer.time([]() { std::this_thread::sleep_for(1ms); return 42; }), 42);
+    timer.time([]() { std::this_thread::sleep_for(1ms); });
+    EXPECT_EQ(stats.calls, 2);
+    EXPECT_GE(stats.wall, 2ms);
+}
+TEST(stage_timer, extrapolates_from_samples_once_called_many_times) {
+    stage_stats stats{};
+    stage_timer timer{ stats };
+    for (int i{ 0 }; i < 100'000; ++i) {
+        timer.time([]() {});
+    }
+    EXPECT_EQ(stats.calls, 100'000);
+    EXPECT_GT(stats.wall, 0ns);
+}
+
+
+TEST(timed_reader, counts_reads_and_bytes) {
+    stage_stats stats{};
+    timed_reader reader{ std::make_unique<memory_reader>("one. two.three"), stats };
+    std::string text{};
+    while (not reader.eof()) {
+        text += reader.read();
+    }
+    EXPECT_EQ(text, "one. two.three");
+    EXPECT_EQ(stats.bytes, text.size());
+    EXPECT_EQ(stats.calls, 3);
+    EXPECT_FALSE(stats.cpu);
+}
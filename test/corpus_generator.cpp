@@ -0,0 +1,84 @@
+#include "corpus_generator.h"
+#include "input_reader.h"
+#include "parallel_converter.h"
+#include "parser.h"
+
+#include <cstdint>  // int64_t
+#include <gtest/gtest.h>
+#include <memory>  // make_unique
+#include <string>
+
+
+// Number to words
+TEST(number_to_words, zero) {
+    EXPECT_EQ(number_to_words(0), "zero");
+}
+TEST(number_to_words, below_one_hundred) {
+    EXPECT_EQ(number_to_words(7), "seven");
+    EXPECT_EQ(number_to_words(13), "thirteen");
+    EXPECT_EQ(number_to_words(40), "forty");
+    EXPECT_EQ(number_to_words(21), "twenty-one");
+    EXPECT_EQ(number_to_words(21, false), "twenty one");
+}
+TEST(number_to_words, below_one_thousand) {
+    EXPECT_EQ(number_to_words(100), "one hundred");
+    EXPECT_EQ(number_to_words(105), "one hundred and five");
+    EXPECT_EQ(number_to_words(999), "nine hundred and ninety-nine");
+}
+TEST(number_to_words, thousands_millions_and_billions) {
+    EXPECT_EQ(number_to_words(1'003), "one thousand and three");
+    EXPECT_EQ(number_to_words(1'200), "one thousand two hundred");
+    EXPECT_EQ(number_to_words(300'040), "three hundred thousand and forty");
+    EXPECT_EQ(number_to_words(3'603'802), "three million six hundred and three thousand eight hundred and two");
+    EXPECT_EQ(number_to_words(1'000'000'000), "one billion");
+}
+TEST(number_to_words, parser_round_trip) {
+    for (int64_t number : { 0, 9, 19, 99, 101, 1'001, 20'020, 999'999, 1'000'001, 12'345'678, 999'999'999 }) {
+        auto text{ number_to_words(number) + "." };
+        EXPECT_EQ(parser{ std::make_unique<memory_reader>(text) }.parse(), std::to_string(number) + ".");
+    }
+}
+
+
+// Corpus generator
+TEST(corpus_generator, same_seed_same_text) {
+    corpus_options options{ .seed = 42, .number_percent = 50 };
+    std::string input_1{};
+    std::string expected_output_1{};
+    corpus_generator{ options }.generate(16 * 1024, input_1, expected_output_1);
+    std::string input_2{};
+    std::string expected_output_2{};
+    corpus_generator{ options }.generate(16 * 1024, input_2, expected_output_2);
+    EXPECT_EQ(input_1, input_2);
+    EXPECT_EQ(expected_output_1, expected_output_2);
+}
+TEST(corpus_generator, different_seed_different_text) {
+    std::string input_1{};
+    std::string expected_output_1{};
+    corpus_generator{ { .seed = 1 } }.generate(1024, input_1, expected_output_1);
+    std::string input_2{};
+    std::string expected_output_2{};
+    corpus_generator{ { .seed = 2 } }.generate(1024, input_2, expected_output_2);
+    EXPECT_NE(input_1, input_2);
+}
+TEST(corpus_generator, no_numbers) {
+    std::string input{};
+    std::string expected_output{};
+    corpus_generator{ { .number_percent = 0 } }.generate(1024, input, expected_output);
+    EXPECT_GE(input.size(), 1024);
+    EXPECT_EQ(input, expected_output);
+}
+TEST(corpus_generator, parse_large_input) {
+    std::string input{};
+    std::string expected_output{};
+    corpus_generator{ { .seed = 7, .number_percent = 50 } }.generate(1024 * 1024, input, expected_output);
+    EXPECT_EQ(parser{ std::make_unique<memory_reader>(input) }.parse(), expected_output);
+}
+TEST(corpus_generator, parallel_convert_large_input) {
+    std::string input{};
+    std::string expected_output{};
+    corpus_generator{ { .seed = 8, .words_per_sentence = 30, .number_percent = 100 } }.generate(1024 * 1024, input, expected_output);
+    std::string output{};
+    parallel_converter{ 4, 64 * 1024 }.convert(input, [&output](const std::string& chunk) { output += chunk; });
+    EXPECT_EQ(output, expected_output);
+}
@@ -0,0 +1,43 @@
+#ifndef _WIN32
+
+#include "file_descriptor.h"
+
+#include <gtest/gtest.h>
+#include <utility>  // move
+
+#include <fcntl.h>  // fcntl, open
+
+
+namespace {
+    [[nodiscard]] bool is_open(int fd) {
+        return ::fcntl(fd, F_GETFD) != -1;
+    }
+}  // namespace
+
+
+TEST(file_descriptor, default_constructor) {
+    file_descriptor fd{};
+    EXPECT_EQ(fd.get(), -1);
+}
+TEST(file_descriptor, destructor_closes) {
+    int raw_fd{ ::open("/dev/null", O_RDONLY) };
+    ASSERT_NE(raw_fd, -1);
+    {
+        file_descriptor fd{ raw_fd };
+        EXPECT_TRUE(is_open(raw_fd));
+    }
+    EXPECT_FALSE(is_open(raw_fd));
+}
+TEST(file_descriptor, move) {
+    int raw_fd{ ::open("/dev/null", O_RDONLY) };
+    ASSERT_NE(raw_fd, -1);
+    file_descriptor fd{ raw_fd };
+    file_descriptor other{ std::move(fd) };
+    EXPECT_EQ(fd.get(), -1);
+    EXPECT_EQ(other.get(), raw_fd);
+    other.close();
+    EXPECT_EQ(other.get(), -1);
+    EXPECT_FALSE(is_open(raw_fd));
+}
+
+#endif  // _WIN32
@@ -1,8 +1,16 @@
 #include "input_reader.h"
+#include "temporary_path.h"
 
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <sstream>  // istringstream
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
 
 
 TEST(file_reader_constructor, file_is_not_a_regular_file) {
@@ -39,6 +47,132 @@ TEST(file_reader_read_sentence, file_with_multiline_sentence) {
     EXPECT_FALSE(file_reader_up->eof());
 }
 
+TEST(mapped_file_reader_constructor, file_is_not_a_regular_file) {
+    EXPECT_THROW((void) std::make_unique<mapped_file_reader>("foo.txt"), file_is_not_a_regular_file_error);
+}
+TEST(mapped_file_reader_read_sentence, empty_file) {
+    std::unique_ptr<input_reader> mapped_file_reader_up{ std::make_unique<mapped_file_reader>("../../res/empty_file.txt")};
+    EXPECT_EQ(mapped_file_reader_up->read(), "");
+    EXPECT_TRUE(mapped_file_reader_up->fail());
+    EXPECT_TRUE(mapped_file_reader_up->eof());
+}
+TEST(mapped_file_reader_read_sentence, file_with_only_a_period) {
+    std::unique_ptr<input_reader> mapped_file_reader_up{ std::make_unique<mapped_file_reader>("../../res/file_with_only_a_period.txt")};
+    EXPECT_EQ(mapped_file_reader_up->read(), ".");
+    EXPECT_FALSE(mapped_file_reader_up->fail());
+    EXPECT_FALSE(mapped_file_reader_up->eof());
+}
+TEST(mapped_file_reader_read_sentence, file_with_text_and_a_period) {
+    std::unique_ptr<input_reader> mapped_file_reader_up{ std::make_unique<mapped_file_reader>("../../res/file_with_text_and_a_period.txt")};
+    EXPECT_EQ(mapped_file_reader_up->read(), "blah.");
+    EXPECT_FALSE(mapped_file_reader_up->fail());
+    EXPECT_FALSE(mapped_file_reader_up->eof());
+}
+TEST(mapped_file_reader_read_sentence, file_with_text_and_no_period) {
+    std::unique_ptr<input_reader> mapped_file_reader_up{ std::make_unique<mapped_file_reader>("../../res/file_with_text_and_no_period.txt")};
+    EXPECT_EQ(mapped_file_reader_up->read(), "blah");
+    EXPECT_FALSE(mapped_file_reader_up->fail());
+    EXPECT_TRUE(mapped_file_reader_up->eof());
+}
+TEST(mapped_file_reader_read_sentence, file_with_multiline_sentence) {
+    std::unique_ptr<input_reader> mapped_file_reader_up{ std::make_unique<mapped_file_reader>("../../res/file_with_multiline_sentence.txt")};
+    EXPECT_EQ(mapped_file_reader_up->read(), "blah\nfoo.");
+    EXPECT_FALSE(mapped_file_reader_up->fail());
+    EXPECT_FALSE(mapped_file_reader_up->eof());
+}
+
+#ifndef _WIN32
+TEST(async_file_reader_constructor, file_is_not_a_regular_file) {
+    EXPECT_THROW((void) std::make_unique<async_file_reader>("foo.txt"), file_is_not_a_regular_file_error);
+}
+TEST(async_file_reader_read_sentence, empty_file) {
+    std::unique_ptr<input_reader> async_file_reader_up{ std::make_unique<async_file_reader>("../../res/empty_file.txt") };
+    EXPECT_EQ(async_file_reader_up->read(), "");
+    EXPECT_TRUE(async_file_reader_up->fail());
+    EXPECT_TRUE(async_file_reader_up->eof());
+}
+TEST(async_file_reader_read_sentence, file_with_only_a_period) {
+    std::unique_ptr<input_reader> async_file_reader_up{ std::make_unique<async_file_reader>("../../res/file_with_only_a_period.txt") };
+    EXPECT_EQ(async_file_reader_up->read(), ".");
+    EXPECT_FALSE(async_file_reader_up->fail());
+    EXPECT_FALSE(async_file_reader_up->eof());
+    EXPECT_EQ(async_file_reader_up->read(), "");
+    EXPECT_TRUE(async_file_reader_up->fail());
+    EXPECT_TRUE(async_file_reader_up->eof());
+}
+TEST(async_file_reader_read_sentence, file_with_text_and_no_period) {
+    std::unique_ptr<input_reader> async_file_reader_up{ std::make_unique<async_file_reader>("../../res/file_with_text_and_no_period.txt") };
+    EXPECT_EQ(async_file_reader_up->read(), "blah");
+    EXPECT_FALSE(async_file_reader_up->fail());
+    EXPECT_TRUE(async_file_reader_up->eof());
+}
+TEST(async_file_reader_read_sentence, file_with_multiline_sentence) {
+    std::unique_ptr<input_reader> async_file_reader_up{ std::make_unique<async_file_reader>("../../res/file_with_multiline_sentence.txt") };
+    EXPECT_EQ(async_file_reader_up->read(), "blah\nfoo.");
+    EXPECT_FALSE(async_file_reader_up->fail());
+    EXPECT_FALSE(async_file_reader_up->eof());
+}
+// Small blocks, so that sentences span one, two, or more blocks, and reads wrap around the ring of buffers
+TEST(async_file_reader_read_sentence, sentences_spanning_blocks) {
+    temporary_path file_path{ "async_file_reader" };
+    std::string text{};
+    for (int i{ 0 }; i < 200; ++i) {
+        text += fmt::format("{}{}.", std::string(static_cast<size_t>(i % 23), 'a'), i);
+    }
+    text += "no period";
+    {
+        std::ofstream ofs{ file_path.get(), std::ios::binary };
+        ofs << text;
+    }
+    for (auto backend : { io_backend::io_uring, io_backend::sync }) {
+        async_file_reader reader{ file_path, backend, 16, 3 };
+        memory_reader expected_reader{ text };
+        std::vector<std::string> sentences{};
+        std::vector<std::string> expected_sentences{};
+        while (not reader.eof()) {
+            sentences.emplace_back(reader.read());
+        }
+        while (not expected_reader.eof()) {
+            expected_sentences.emplace_back(expected_reader.read());
+        }
+        EXPECT_EQ(sentences, expected_sentences);
+        EXPECT_FALSE(reader.fail());
+    }
+}
+#endif  // _WIN32
+
+TEST(memory_reader_read_sentence, empty_string) {
+    std::unique_ptr<input_reader> memory_reader_up{ std::make_unique<memory_reader>("") };
+    EXPECT_EQ(memory_reader_up->read(), "");
+    EXPECT_TRUE(memory_reader_up->fail());
+    EXPECT_TRUE(memory_reader_up->eof());
+}
+TEST(memory_reader_read_sentence, text_with_only_a_period) {
+    std::unique_ptr<input_reader> memory_reader_up{ std::make_unique<memory_reader>(".") };
+    EXPECT_EQ(memory_reader_up->read(), ".");
+    EXPECT_FALSE(memory_reader_up->fail());
+    EXPECT_FALSE(memory_reader_up->eof());
+    EXPECT_EQ(memory_reader_up->read(), "");
+    EXPECT_TRUE(memory_reader_up->fail());
+    EXPECT_TRUE(memory_reader_up->eof());
+}
+TEST(memory_reader_read_sentence, text_with_text_and_no_period) {
+    std::unique_ptr<input_reader> memory_reader_up{ std::make_unique<memory_reader>("blah") };
+    EXPECT_EQ(memory_reader_up->read(), "blah");
+    EXPECT_FALSE(memory_reader_up->fail());
+    EXPECT_TRUE(memory_reader_up->eof());
+}
+TEST(memory_reader_read_sentence, text_with_multiline_sentence) {
+    std::string text{ "blah\nfoo.meh" };
+    std::unique_ptr<input_reader> memory_reader_up{ std::make_unique<memory_reader>(text) };
+    EXPECT_EQ(memory_reader_up->read(), "blah\nfoo.");
+    EXPECT_FALSE(memory_reader_up->fail());
+    EXPECT_FALSE(memory_reader_up->eof());
+    EXPECT_EQ(memory_reader_up->read(), "meh");
+    EXPECT_FALSE(memory_reader_up->fail());
+    EXPECT_TRUE(memory_reader_up->eof());
+}
+
 TEST(stream_reader_read_sentence, empty_string) {
     std::string text{};
     std::istringstream iss{ text };
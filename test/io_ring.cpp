@@ -0,0 +1,90 @@
+#ifndef _WIN32
+
+#include "file_descriptor.h"
+#include "io_ring.h"
+#include "temporary_path.h"
+
+#include <array>
+#include <gtest/gtest.h>
+#include <string>
+
+#include <fcntl.h>  // open
+
+
+namespace {
+    // Runs every test with both backends, on a temporary file
+    class io_ring_test : public ::testing::TestWithParam<io_backend> {
+    protected:
+        temporary_path file_path{ "io_ring" };
+        file_descriptor fd{};
+
+        void SetUp() override {
+            fd = file_descriptor{ ::open(file_path.get().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666) };
+            ASSERT_NE(fd.get(), -1);
+        }
+        void TearDown() override {
+            fd.close();
+        }
+    };
+}  // namespace
+
+
+TEST(io_ring, sync_backend_is_not_async) {
+    io_ring ring{ 4, io_backend::sync };
+    EXPECT_FALSE(ring.is_async());
+    EXPECT_EQ(ring.in_flight(), 0);
+}
+
+TEST_P(io_ring_test, write_and_read) {
+    io_ring ring{ 4, GetParam() };
+    std::string one{ "One. " };
+    std::string two{ "Two." };
+    ring.write(fd.get(), one.data(), one.size(), 0, 1);
+    ring.write(fd.get(), two.data(), two.size(), one.size(), 2);
+    EXPECT_EQ(ring.in_flight(), 2);
+    std::array<int, 3> results{};
+    for (int i{ 0 }; i < 2; ++i) {
+        auto completion{ ring.wait() };
+        results[completion.user_data] = completion.result;
+    }
+    EXPECT_EQ(ring.in_flight(), 0);
+    EXPECT_EQ(results[1], static_cast<int>(one.size()));
+    EXPECT_EQ(results[2], static_cast<int>(two.size()));
+
+    std::string text(64, '\0');
+    ring.read(fd.get(), text.data(), text.size(), 0, 3);
+    auto completion{ ring.wait() };
+    EXPECT_EQ(completion.user_data, 3);
+    ASSERT_EQ(completion.result, static_cast<int>(one.size() + two.size()));  // short read at the end of the file
+    text.resize(static_cast<size_t>(completion.result));
+    EXPECT_EQ(text, "One. Two.");
+}
+TEST_P(io_ring_test, more_operations_than_entries) {
+    io_ring ring{ 2, GetParam() };
+    std::string text{ "abcdefgh" };
+    for (size_t i{ 0 }; i < text.size(); ++i) {
+        ring.write(fd.get(), text.data() + i, 1, i, i);
+        if (ring.in_flight() == 2) {
+            EXPECT_EQ(ring.wait().result, 1);
+        }
+    }
+    while (ring.in_flight() > 0) {
+        EXPECT_EQ(ring.wait().result, 1);
+    }
+    std::string read_text(text.size(), '\0');
+    ring.read(fd.get(), read_text.data(), read_text.size(), 0, 0);
+    EXPECT_EQ(ring.wait().result, static_cast<int>(text.size()));
+    EXPECT_EQ(read_text, text);
+}
+TEST_P(io_ring_test, error_is_returned_as_a_negated_errno) {
+    io_ring ring{ 4, GetParam() };
+    std::string text(8, '\0');
+    ring.read(-1, text.data(), text.size(), 0, 7);
+    auto completion{ ring.wait() };
+    EXPECT_EQ(completion.user_data, 7);
+    EXPECT_EQ(completion.result, -EBADF);
+}
+
+INSTANTIATE_TEST_SUITE_P(backends, io_ring_test, ::testing::Values(io_backend::io_uring, io_backend::sync));
+
+#endif  // _WIN32
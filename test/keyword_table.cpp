@@ -0,0 +1,33 @@
+#include "keyword_table.h"
+
+#include <algorithm>  // for_each
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+
+static_assert(keyword_table::find("zero")->value == 0);
+static_assert(keyword_table::find("Seventeen")->lexeme == lexeme_t::ten_to_nineteen);
+static_assert(keyword_table::find("zeros") == nullptr);
+
+TEST(keyword_table_find, all_keywords) {
+    std::ranges::for_each(keywords, [](const keyword_t& keyword) {
+        const auto* found{ keyword_table::find(keyword.word) };
+        ASSERT_NE(found, nullptr);
+        EXPECT_EQ(found->word, keyword.word);
+        EXPECT_EQ(found->lexeme, keyword.lexeme);
+        EXPECT_EQ(found->value, keyword.value);
+    });
+}
+TEST(keyword_table_find, case_insensitive) {
+    for (auto word : { "NINETY", "Ninety", "nInEtY" }) {
+        const auto* found{ keyword_table::find(word) };
+        ASSERT_NE(found, nullptr);
+        EXPECT_EQ(found->lexeme, lexeme_t::tens);
+        EXPECT_EQ(found->value, 90);
+    }
+}
+TEST(keyword_table_find, not_keywords) {
+    for (auto word : { "", "a", "an", "on", "ones", "tw", "thirtee", "thirtyy", "fourty", "nineteens", "hundreds", "foo" }) {
+        EXPECT_EQ(keyword_table::find(word), nullptr) << word;
+    }
+}
@@ -1,3 +1,149 @@
+#include "input_reader.h"
+#include "lexer.h"
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <memory>  // make_unique
+#include <ostream>
+#include <sstream>  // istringstream
+#include <string>
+#include <vector>
+
+
+namespace {
+    // Token texts are views into the reader's buffer, so they have to be copied out before reading the next sentence
+    struct owned_token_t {
+        lexeme_t lexeme{};
+        std::string text{};
+
+        [[nodiscard]] bool operator==(const owned_token_t& other) const = default;
+    };
+    std::ostream& operator<<(std::ostream& os, const owned_token_t& t) {
+        return os << token_t{ t.lexeme, t.text };
+    }
+
+    std::vector<owned_token_t> get_tokens(const std::string& text) {
+        std::istringstream iss{ text };
+        lexer lexer{ std::make_unique<stream_reader>(iss) };
+        std::vector<owned_token_t> ret{};
+        auto push_current_token = [&lexer, &ret]() {
+            const auto& token{ lexer.get_current_token() };
+            ret.emplace_back(token.lexeme, std::string{ token.text });
+        };
+        push_current_token();
+        while (lexer.get_current_lexeme() != lexeme_t::end) {
+            lexer.advance_to_next_token();
+            push_current_token();
+        }
+        return ret;
+    }
+}  // namespace
+
+
+TEST(lexer_get_current_token, empty_text) {
+    EXPECT_THAT(get_tokens(""), ::testing::ElementsAre(owned_token_t{ lexeme_t::end, "" }));
+}
+TEST(lexer_get_current_token, spaces) {
+    EXPECT_THAT(get_tokens(" \t\r\n "), ::testing::ElementsAre(
+        owned_token_t{ lexeme_t::space, " \t\r\n " },
+        owned_token_t{ lexeme_t::end, "" }));
+}
+TEST(lexer_get_current_token, dashes_and_periods) {
+    EXPECT_THAT(get_tokens("--.."), ::testing::ElementsAre(
+        owned_token_t{ lexeme_t::dash, "-" },
+        owned_token_t{ lexeme_t::dash, "-" },
+        owned_token_t{ lexeme_t::period, "." },
+        owned_token_t{ lexeme_t::period, "." },
+        owned_token_t{ lexeme_t::end, "" }));
+}
+TEST(lexer_get_current_token, words) {
+    EXPECT_THAT(get_tokens("Twenty-ONE and foo"), ::testing::ElementsAre(
+        owned_token_t{ lexeme_t::tens, "Twenty" },
+        owned_token_t{ lexeme_t::dash, "-" },
+        owned_token_t{ lexeme_t::one, "ONE" },
+        owned_token_t{ lexeme_t::space, " " },
+        owned_token_t{ lexeme_t::and_connector, "and" },
+        owned_token_t{ lexeme_t::space, " " },
+        owned_token_t{ lexeme_t::other, "foo" },
+        owned_token_t{ lexeme_t::end, "" }));
+}
+TEST(lexer_get_current_token, other_text_before_a_word) {
+    EXPECT_THAT(get_tokens("1,two"), ::testing::ElementsAre(
+        owned_token_t{ lexeme_t::other, "1," },
+        owned_token_t{ lexeme_t::two_to_nine, "two" },
+        owned_token_t{ lexeme_t::end, "" }));
+}
+TEST(lexer_get_current_token, other_text_at_the_end_of_a_sentence) {
+    EXPECT_THAT(get_tokens("nine!?. (ten)"), ::testing::ElementsAre(
+        owned_token_t{ lexeme_t::two_to_nine, "nine" },
+        owned_token_t{ lexeme_t::other, "!?" },
+        owned_token_t{ lexeme_t::period, "." },
+        owned_token_t{ lexeme_t::space, " " },
+        owned_token_t{ lexeme_t::other, "(" },
+        owned_token_t{ lexeme_t::ten_to_nineteen, "ten" },
+        owned_token_t{ lexeme_t::other, ")" },
+        owned_token_t{ lexeme_t::end, "" }));
+}
+TEST(lexer_get_current_token, words_made_of_number_words) {
+    EXPECT_THAT(get_tokens("onetwo"), ::testing::ElementsAre(
+        owned_token_t{ lexeme_t::other, "onetwo" },
+        owned_token_t{ lexeme_t::end, "" }));
+}
+
+TEST(lexer_get_current_token, number_word_values) {
+    std::istringstream iss{ "Twenty-ONE" };
+    lexer lexer{ std::make_unique<stream_reader>(iss) };
+    EXPECT_EQ(lexer.get_current_token().value, 20);
+    lexer.advance_to_next_token();
+    lexer.advance_to_next_token();
+    EXPECT_EQ(lexer.get_current_token().value, 1);
+}
+TEST(lexer_get_current_token, text_without_candidate_words_is_a_single_token) {
+    EXPECT_THAT(get_tokens("A quick - brown fox, (again)"), ::testing::ElementsAre(
+        owned_token_t{ lexeme_t::other, "A quick - brown fox, (again)" },
+        owned_token_t{ lexeme_t::end, "" }));
+}
+TEST(lexer_get_current_token, spaces_and_dashes_after_a_number_word) {
+    EXPECT_THAT(get_tokens("foo, twenty - one bar baz. qux"), ::testing::ElementsAre(
+        owned_token_t{ lexeme_t::other, "foo, " },
+        owned_token_t{ lexeme_t::tens, "twenty" },
+        owned_token_t{ lexeme_t::space, " " },
+        owned_token_t{ lexeme_t::dash, "-" },
+        owned_token_t{ lexeme_t::space, " " },
+        owned_token_t{ lexeme_t::one, "one" },
+        owned_token_t{ lexeme_t::space, " " },
+        owned_token_t{ lexeme_t::other, "bar baz" },
+        owned_token_t{ lexeme_t::period, "." },
+        owned_token_t{ lexeme_t::space, " " },
+        owned_token_t{ lexeme_t::other, "qux" },
+        owned_token_t{ lexeme_t::end, "" }));
+}
+
+TEST(lexer_get_current_sentence, sentence_and_offset_of_the_current_token) {
+    lexer lexer{ std::make_unique<memory_reader>("one. foo two.") };
+    EXPECT_EQ(lexer.get_current_sentence(), "one.");
+    EXPECT_EQ(lexer.get_current_sentence_offset(), 0);
+    while (lexer.get_current_text() != "two") {
+        lexer.advance_to_next_token();
+    }
+    EXPECT_EQ(lexer.get_current_sentence(), " foo two.");
+    EXPECT_EQ(lexer.get_current_sentence_offset(), 4);
+}
 
+TEST(lexer_get_token_count, does_not_count_the_end_token) {
+    EXPECT_EQ(lexer{ std::make_unique<memory_reader>("") }.get_token_count(), 0);
+    for (std::string text : { "one", "one. foo two.", "Twenty-one thousand and five. foo\nbar." }) {
+        lexer lexer{ std::make_unique<memory_reader>(text) };
+        while (lexer.get_current_lexeme() != lexeme_t::end) {
+            lexer.advance_to_next_token();
+        }
+        EXPECT_EQ(lexer.get_token_count(), get_tokens(text).size() - 1);
+    }
+}
+TEST(lexer_get_token_count, reset) {
+    lexer lexer{ std::make_unique<memory_reader>("one two.") };
+    lexer.advance_to_next_token();
+    EXPECT_EQ(lexer.get_token_count(), 2);
+    lexer.reset(std::make_unique<memory_reader>("three"));
+    EXPECT_EQ(lexer.get_token_count(), 1);
+}
@@ -0,0 +1,129 @@
+#include "corpus_generator.h"
+#include "input_reader.h"
+#include "number_expression_machine.h"
+#include "parser.h"
+#include "translator.h"
+
+#include <array>
+#include <exception>
+#include <gtest/gtest.h>
+#include <memory>  // make_unique
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace number_expression_machine;
+
+
+namespace {
+    // Output of a conversion, or nullopt if it throws
+    std::optional<std::string> parse(std::string_view text) {
+        try {
+            return parser{ std::make_unique<memory_reader>(text) }.parse();
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+
+    std::optional<std::string> translate(std::string_view text) {
+        try {
+            return translator{ std::make_unique<memory_reader>(text) }.translate();
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+
+    // Calls f with every sequence of up to max_length words, joined by separator
+    template <typename F>
+    void for_each_sequence(const std::vector<std::string_view>& words, size_t max_length, std::string_view separator, F&& f) {
+        std::vector<size_t> indices{};
+        std::string text{};
+        auto visit = [&](auto& self) -> void {
+            text.clear();
+            for (size_t i{ 0 }; i < indices.size(); ++i) {
+                if (i != 0) {
+                    text += separator;
+                }
+                text += words[indices[i]];
+            }
+            f(text);
+            if (indices.size() == max_length) {
+                return;
+            }
+            for (size_t i{ 0 }; i < words.size(); ++i) {
+                indices.push_back(i);
+                self(self);
+                indices.pop_back();
+            }
+        };
+        visit(visit);
+    }
+}  // namespace
+
+
+// Table
+TEST(number_expression_machine_table, start_only_takes_number_words_that_can_begin_an_expression) {
+    for (auto lexeme : { lexeme_t::zero, lexeme_t::one, lexeme_t::two_to_nine, lexeme_t::ten_to_nineteen, lexeme_t::tens }) {
+        EXPECT_FALSE(is_final(next(state_t::start, lexeme)));
+    }
+    for (auto lexeme : { lexeme_t::hundred, lexeme_t::thousand, lexeme_t::million, lexeme_t::billion,
+        lexeme_t::and_connector, lexeme_t::dash, lexeme_t::period, lexeme_t::other, lexeme_t::end }) {
+        EXPECT_EQ(next(state_t::start, lexeme), state_t::reject);
+    }
+}
+TEST(number_expression_machine_table, text_ends_every_expression) {
+    for (size_t state{ 1 }; state < state_count; ++state) {
+        for (auto lexeme : { lexeme_t::period, lexeme_t::other, lexeme_t::end }) {
+            EXPECT_TRUE(is_final(next(static_cast<state_t>(state), lexeme)));
+        }
+    }
+}
+TEST(number_expression_machine_accepts, whole_expressions) {
+    EXPECT_TRUE(accepts({ lexeme_t::one, lexeme_t::million, lexeme_t::two_to_nine, lexeme_t::thousand,
+        lexeme_t::and_connector, lexeme_t::two_to_nine }));
+    EXPECT_TRUE(accepts({ lexeme_t::tens, lexeme_t::dash, lexeme_t::one, lexeme_t::hundred }));
+}
+TEST(number_expression_machine_accepts, expressions_not_taking_the_last_word) {
+    EXPECT_FALSE(accepts({ lexeme_t::zero, lexeme_t::one }));
+    EXPECT_FALSE(accepts({ lexeme_t::one, lexeme_t::thousand, lexeme_t::thousand }));
+}
+TEST(number_expression_machine_accepts, malformed_expressions) {
+    EXPECT_FALSE(accepts({ lexeme_t::tens, lexeme_t::dash, lexeme_t::and_connector }));
+    EXPECT_FALSE(accepts({ lexeme_t::million }));
+}
+
+
+// Equivalence with the recursive-descent parser
+TEST(number_expression_machine_equivalence, every_sequence_of_up_to_four_words) {
+    static const std::vector<std::string_view> words{
+        "zero", "one", "two", "ten", "twenty", "hundred", "thousand", "million", "billion", "and", "-", "foo"
+    };
+    for_each_sequence(words, 4, " ", [](const std::string& sentence) {
+        auto text{ sentence + "." };
+        ASSERT_EQ(translate(text), parse(text)) << "text: '" << text << "'";
+    });
+}
+TEST(number_expression_machine_equivalence, every_sequence_of_up_to_four_words_without_spaces_around_dashes) {
+    static const std::vector<std::string_view> words{
+        "one", "two", "ten", "twenty", "hundred", "thousand", "million", "billion", "and", "-"
+    };
+    for_each_sequence(words, 4, " ", [](const std::string& sentence) {
+        std::string text{};
+        for (size_t i{ 0 }; i < sentence.size(); ++i) {
+            bool around_dash{ (sentence[i] == ' ') and
+                ((i > 0 and sentence[i - 1] == '-') or (i + 1 < sentence.size() and sentence[i + 1] == '-')) };
+            if (not around_dash) {
+                text += sentence[i];
+            }
+        }
+        ASSERT_EQ(translate(text), parse(text)) << "text: '" << text << "'";
+    });
+}
+TEST(number_expression_machine_equivalence, generated_corpus) {
+    std::string input{};
+    std::string expected_output{};
+    corpus_generator{ { .seed = 7, .number_percent = 100, .max_magnitude = magnitude_t::billions } }.generate(256 * 1024, input, expected_output);
+    EXPECT_EQ(translate(input), parse(input));
+    EXPECT_EQ(translate(input), expected_output);
+}
@@ -1,7 +1,21 @@
 #include "output_writer.h"
+#include "read_file.h"
+#include "temporary_path.h"
 
+#include <array>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>  // open
+#include <unistd.h>  // pipe, read
+#endif
+
+namespace fs = std::filesystem;
 
 
 TEST(file_writer_constructor, could_not_create_file) {
@@ -43,3 +57,215 @@ TEST(stream_writer_write, write_multiline_text_with_period) {
     output_writer_up->write(text);
     EXPECT_EQ(oss.str(), text);
 }
+
+// Writes text into a stream buffer that counts how many times it is flushed
+struct flush_counter : public std::stringbuf {
+    int flushes{ 0 };
+    int sync() override { ++flushes; return std::stringbuf::sync(); }
+};
+TEST(stream_writer_write, no_flush_policy) {
+    flush_counter buffer{};
+    std::ostream os{ &buffer };
+    stream_writer writer{ os };
+    writer.write("One.");
+    writer.write(" Two.");
+    EXPECT_EQ(buffer.flushes, 0);
+    EXPECT_EQ(buffer.str(), "One. Two.");
+}
+TEST(stream_writer_write, flush_every_write) {
+    flush_counter buffer{};
+    std::ostream os{ &buffer };
+    stream_writer writer{ os };
+    writer.set_flush_policy({});
+    writer.write("One.");
+    EXPECT_EQ(buffer.flushes, 1);
+    writer.write(" Two.");
+    EXPECT_EQ(buffer.flushes, 2);
+}
+TEST(stream_writer_write, flush_bytes) {
+    flush_counter buffer{};
+    std::ostream os{ &buffer };
+    stream_writer writer{ os };
+    writer.set_flush_policy({ .bytes = 8 });
+    writer.write("One.");
+    EXPECT_EQ(buffer.flushes, 0);
+    writer.write(" Two.");
+    EXPECT_EQ(buffer.flushes, 1);
+    writer.write(" Six.");
+    EXPECT_EQ(buffer.flushes, 1);
+}
+TEST(stream_writer_write, flush_interval) {
+    flush_counter buffer{};
+    std::ostream os{ &buffer };
+    stream_writer writer{ os };
+    writer.set_flush_policy({ .interval = std::chrono::hours{ 1 } });
+    writer.write("One.");
+    EXPECT_EQ(buffer.flushes, 0);
+    writer.set_flush_policy({ .interval = std::chrono::milliseconds{ 0 } });
+    writer.write(" Two.");
+    EXPECT_EQ(buffer.flushes, 1);
+}
+
+
+#ifndef _WIN32
+namespace {
+    [[nodiscard]] std::string read_pipe(int fd) {
+        std::string ret(1024, '\0');
+        auto n{ ::read(fd, ret.data(), ret.size()) };
+        ret.resize(n > 0 ? static_cast<size_t>(n) : 0);
+        return ret;
+    }
+
+    // Creates a pipe, and paths for temporary output files
+    class multi_sink_writer_test : public ::testing::Test {
+    protected:
+        temporary_path first_file_path{ "first" };
+        temporary_path second_file_path{ "second" };
+        file_descriptor pipe_reader{};
+        file_descriptor pipe_writer{};
+
+        void SetUp() override {
+            std::array<int, 2> fds{};
+            ASSERT_NE(::pipe(fds.data()), -1);
+            pipe_reader = file_descriptor{ fds[0] };
+            pipe_writer = file_descriptor{ fds[1] };
+        }
+    };
+}  // namespace
+
+
+TEST(multi_sink_writer_add_sink, could_not_create_file) {
+    multi_sink_writer writer{};
+    EXPECT_THROW(writer.add_sink(fs::path{ "blah/foo.txt" }), could_not_create_file_error);
+}
+
+TEST_F(multi_sink_writer_test, text_is_buffered_until_flushed) {
+    multi_sink_writer writer{};
+    writer.add_sink(first_file_path);
+    writer.write("One.");
+    writer.write(" Two.");
+    EXPECT_EQ(read_file(first_file_path), "");
+    writer.flush();
+    EXPECT_EQ(read_file(first_file_path), "One. Two.");
+}
+TEST_F(multi_sink_writer_test, text_is_written_out_when_the_buffer_is_full) {
+    multi_sink_writer writer{ 8 };
+    writer.add_sink(first_file_path);
+    writer.write("One.");
+    EXPECT_EQ(read_file(first_file_path), "");
+    writer.write(" Two.");
+    EXPECT_EQ(read_file(first_file_path), "One. Two.");
+    writer.write(" Six.");
+    EXPECT_EQ(read_file(first_file_path), "One. Two.");
+    writer.write(" Twenty-one.");
+    EXPECT_EQ(read_file(first_file_path), "One. Two. Six. Twenty-one.");
+}
+TEST_F(multi_sink_writer_test, flush_every_write) {
+    multi_sink_writer writer{};
+    writer.add_sink(first_file_path);
+    writer.set_flush_policy({});
+    writer.write("One.");
+    EXPECT_EQ(read_file(first_file_path), "One.");
+    writer.write(" Two.");
+    EXPECT_EQ(read_file(first_file_path), "One. Two.");
+}
+TEST_F(multi_sink_writer_test, destructor_writes_out_pending_text) {
+    {
+        multi_sink_writer writer{};
+        writer.add_sink(first_file_path);
+        writer.write("One.");
+    }
+    EXPECT_EQ(read_file(first_file_path), "One.");
+}
+TEST_F(multi_sink_writer_test, file_duplicated_into_file) {
+    multi_sink_writer writer{ 8 };
+    writer.add_sink(first_file_path);
+    writer.add_sink(second_file_path);
+    writer.write("One.");
+    writer.write(" Two. Twenty-one.");
+    writer.write(" Six.");
+    writer.flush();
+    EXPECT_EQ(read_file(first_file_path), "One. Two. Twenty-one. Six.");
+    EXPECT_EQ(read_file(second_file_path), "One. Two. Twenty-one. Six.");
+    EXPECT_EQ(writer.get_copied_bytes(), std::string_view{ "One. Two. Twenty-one. Six." }.size());
+}
+TEST_F(multi_sink_writer_test, file_duplicated_into_pipe) {
+    multi_sink_writer writer{};
+    writer.add_sink(pipe_writer.get());
+    writer.add_sink(first_file_path);
+    writer.write("One.");
+    writer.flush();
+    EXPECT_EQ(read_pipe(pipe_reader.get()), "One.");
+    writer.write(" Two.");
+    writer.flush();
+    EXPECT_EQ(read_pipe(pipe_reader.get()), " Two.");
+    EXPECT_EQ(read_file(first_file_path), "One. Two.");
+    EXPECT_EQ(writer.get_copied_bytes(), std::string_view{ "One. Two." }.size());
+}
+TEST_F(multi_sink_writer_test, write_only_file_is_not_duplicated) {
+    file_descriptor first_file{ ::open(first_file_path.get().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666) };
+    ASSERT_NE(first_file.get(), -1);
+    multi_sink_writer writer{};
+    writer.add_sink(first_file.get());
+    writer.add_sink(pipe_writer.get());
+    writer.write("One.");
+    writer.flush();
+    EXPECT_EQ(read_pipe(pipe_reader.get()), "One.");
+    EXPECT_EQ(read_file(first_file_path), "One.");
+    EXPECT_EQ(writer.get_copied_bytes(), 0);
+}
+TEST_F(multi_sink_writer_test, file_opened_for_appending_duplicated_into_file) {
+    {
+        std::ofstream ofs{ first_file_path.get() };
+        ofs << "Zero.";
+    }
+    file_descriptor first_file{ ::open(first_file_path.get().c_str(), O_WRONLY | O_APPEND) };
+    ASSERT_NE(first_file.get(), -1);
+    multi_sink_writer writer{};
+    writer.add_sink(first_file.get());
+    writer.add_sink(second_file_path);
+    writer.write(" One.");
+    writer.flush();
+    EXPECT_EQ(read_file(first_file_path), "Zero. One.");
+    EXPECT_EQ(read_file(second_file_path), " One.");
+}
+TEST_F(multi_sink_writer_test, write_error) {
+    multi_sink_writer writer{};
+    writer.add_sink(pipe_reader.get());
+    writer.write("One.");
+    EXPECT_THROW(writer.flush(), output_error);
+}
+
+TEST(async_file_writer_constructor, could_not_create_file) {
+    EXPECT_THROW((void) std::make_unique<async_file_writer>("blah/foo.txt"), could_not_create_file_error);
+}
+TEST_F(multi_sink_writer_test, async_file_writer_write) {
+    for (auto backend : { io_backend::io_uring, io_backend::sync }) {
+        async_file_writer writer{ first_file_path, backend, 8, 2 };
+        std::string expected_text{};
+        for (int i{ 0 }; i < 100; ++i) {
+            auto sentence{ fmt::format("{}{}.", std::string(static_cast<size_t>(i % 19), ' '), i) };
+            writer.write(sentence);
+            expected_text += sentence;
+        }
+        writer.flush();
+        EXPECT_EQ(read_file(first_file_path), expected_text);
+    }
+}
+TEST_F(multi_sink_writer_test, async_file_writer_flush_every_write) {
+    async_file_writer writer{ first_file_path };
+    writer.set_flush_policy({});
+    writer.write("One.");
+    EXPECT_EQ(read_file(first_file_path), "One.");
+    writer.write(" Two.");
+    EXPECT_EQ(read_file(first_file_path), "One. Two.");
+}
+TEST_F(multi_sink_writer_test, async_file_writer_destructor_writes_out_pending_text) {
+    {
+        async_file_writer writer{ first_file_path };
+        writer.write("One.");
+        EXPECT_EQ(read_file(first_file_path), "");
+    }
+    EXPECT_EQ(read_file(first_file_path), "One.");
+}
+#endif  // _WIN32
@@ -0,0 +1,128 @@
+#include "input_reader.h"
+#include "parallel_converter.h"
+#include "parser.h"
+#include "read_file.h"
+#include "translator.h"
+
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <memory>  // make_unique
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+    std::string serial_convert(std::string_view text) {
+        return std::make_unique<parser>(std::make_unique<memory_reader>(text))->parse();
+    }
+
+    std::string parallel_convert(std::string_view text, size_t jobs, size_t chunk_size) {
+        std::string ret{};
+        parallel_converter{ jobs, chunk_size }.convert(text, [&ret](const std::string& chunk) {
+            ret += chunk;
+        });
+        return ret;
+    }
+}  // namespace
+
+
+// Split into chunks
+TEST(split_into_chunks, empty_text) {
+    EXPECT_TRUE(split_into_chunks("", 4).empty());
+}
+TEST(split_into_chunks, text_without_periods) {
+    EXPECT_EQ(split_into_chunks("foo bar blah", 4), (std::vector<std::string_view>{ "foo bar blah" }));
+}
+TEST(split_into_chunks, text_shorter_than_chunk_size) {
+    EXPECT_EQ(split_into_chunks("foo. bar.", 64), (std::vector<std::string_view>{ "foo. bar." }));
+}
+TEST(split_into_chunks, chunks_end_after_a_period) {
+    EXPECT_EQ(split_into_chunks("foo. bar. blah.", 4), (std::vector<std::string_view>{ "foo.", " bar.", " blah." }));
+}
+TEST(split_into_chunks, chunks_span_several_sentences) {
+    EXPECT_EQ(split_into_chunks("a. b. c. d. e", 5), (std::vector<std::string_view>{ "a. b.", " c. d.", " e" }));
+}
+TEST(split_into_chunks, chunk_size_of_0) {
+    EXPECT_EQ(split_into_chunks("a.b.", 0), (std::vector<std::string_view>{ "a.", "b." }));
+}
+
+
+// Convert
+TEST(parallel_converter_convert, empty_input_text) {
+    EXPECT_EQ(parallel_convert("", 4, 1), "");
+}
+TEST(parallel_converter_convert, one_chunk) {
+    std::string_view text{ "one. foo two.three" };
+    EXPECT_EQ(parallel_convert(text, 4, 1024), serial_convert(text));
+}
+TEST(parallel_converter_convert, many_chunks) {
+    std::string_view text{ "one. foo two.three. Twenty-one thousand and five. one hundred and one. foo\nbar. ninety-nine" };
+    for (size_t chunk_size{ 1 }; chunk_size < text.size(); ++chunk_size) {
+        EXPECT_EQ(parallel_convert(text, 3, chunk_size), serial_convert(text));
+    }
+}
+TEST(parallel_converter_convert, more_chunks_than_chunks_in_flight) {
+    std::string text{};
+    for (int i{ 0 }; i < 1000; ++i) {
+        text += "one million two hundred and three thousand and four. foo twenty-two. ";
+    }
+    EXPECT_EQ(parallel_convert(text, 2, 16), serial_convert(text));
+}
+TEST(parallel_converter_convert, malformed_number_in_a_chunk) {
+    std::string_view text{ "one. two. one two. three." };
+    std::string output{};
+    EXPECT_THROW(parallel_converter(4, 1).convert(text, [&output](const std::string& chunk) {
+        output += chunk;
+    }), invalid_token_error);
+    EXPECT_EQ(output, "1. 2.");
+}
+TEST(parallel_converter_convert, recover_from_malformed_sentences) {
+    std::string_view text{ "one. one two. three. four five. six." };
+    for (size_t chunk_size{ 1 }; chunk_size < text.size(); ++chunk_size) {
+        std::string output{};
+        std::vector<size_t> offsets{};
+        parallel_converter(3, chunk_size).convert(text,
+            [&output](const std::string& chunk) { output += chunk; },
+            [&offsets](const sentence_error& error) { offsets.push_back(error.offset); });
+        EXPECT_EQ(output, "1. one two. 3. four five. 6.");
+        EXPECT_EQ(offsets, (std::vector<size_t>{ 4, 20 }));
+    }
+}
+TEST(parallel_converter_convert, recover_from_invalid_number_expressions) {
+    std::string_view text{ "one. one hundred hundred. five." };
+    for (size_t chunk_size{ 1 }; chunk_size < text.size(); ++chunk_size) {
+        std::string output{};
+        std::vector<sentence_error> errors{};
+        parallel_converter(3, chunk_size).convert(text,
+            [&output](const std::string& chunk) { output += chunk; },
+            [&errors](const sentence_error& error) { errors.push_back(error); });
+        EXPECT_EQ(output, "1. one hundred hundred. 5.");
+        ASSERT_EQ(errors.size(), 1);
+        EXPECT_EQ(errors[0].offset, 4);
+        EXPECT_EQ(errors[0].message, "invalid number expression: '100 100'");
+    }
+}
+TEST(parallel_converter_convert, in_1_txt) {
+    auto input{ read_file("../../res/in_1.txt") };
+    EXPECT_EQ(parallel_convert(input, 4, 16), read_file("../../res/out_1.txt"));
+}
+TEST(parallel_converter_convert, in_2_txt) {
+    auto input{ read_file("../../res/in_2.txt") };
+    EXPECT_EQ(parallel_convert(input, 4, 16), read_file("../../res/out_2.txt"));
+}
+
+
+// Counters
+TEST(parallel_converter_get_counters, same_as_a_serial_conversion) {
+    std::string_view text{ "one. foo two.three. Twenty-one thousand and five. one hundred and one. foo\nbar. ninety-nine" };
+    translator t{ std::make_unique<memory_reader>(text) };
+    (void) t.translate();
+    for (size_t chunk_size{ 1 }; chunk_size < text.size(); chunk_size += 7) {
+        parallel_converter converter{ 3, chunk_size };
+        converter.convert(text, [](const std::string&) {});
+        EXPECT_EQ(converter.get_counters(), t.get_counters());
+    }
+}
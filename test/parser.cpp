@@ -1,10 +1,16 @@
+#include "allocation_counter.h"
+#include "corpus_generator.h"
 #include "input_reader.h"
+#include "output_writer.h"
 #include "parser.h"
 
+#include <algorithm>  // count
 #include <fmt/format.h>
 #include <filesystem>
 #include <gtest/gtest.h>
 #include <sstream>  // istringstream
+#include <string>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -78,6 +84,18 @@ TEST(parser_parse, in_2_txt) {
     std::string expected_output_str{ std::istreambuf_iterator{ expected_output_ifs }, {} };
     EXPECT_EQ(std::make_unique<parser>(std::make_unique<file_reader>(input_file_path))->parse(), expected_output_str);
 }
+TEST(parser_parse, in_1_txt_mapped_file) {
+    fs::path input_file_path{ "../../res/in_1.txt" };
+    std::ifstream expected_output_ifs{ "../../res/out_1.txt" };
+    std::string expected_output_str{ std::istreambuf_iterator{ expected_output_ifs }, {} };
+    EXPECT_EQ(std::make_unique<parser>(std::make_unique<mapped_file_reader>(input_file_path))->parse(), expected_output_str);
+}
+TEST(parser_parse, in_2_txt_mapped_file) {
+    fs::path input_file_path{ "../../res/in_2.txt" };
+    std::ifstream expected_output_ifs{ "../../res/out_2.txt" };
+    std::string expected_output_str{ std::istreambuf_iterator{ expected_output_ifs }, {} };
+    EXPECT_EQ(std::make_unique<parser>(std::make_unique<mapped_file_reader>(input_file_path))->parse(), expected_output_str);
+}
 
 // Text and numbers
 TEST(parser_parse, number) {
@@ -254,6 +272,15 @@ TEST(parser_parse, one_billion) {
     std::istringstream iss{ "one billion." };
     EXPECT_EQ(std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse(), fmt::format("{}.", 1'000'000'000));
 }
+TEST(parser_parse, nine_hundred_billion) {
+    std::istringstream iss{ "nine hundred billion." };
+    EXPECT_EQ(std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse(), fmt::format("{}.", 900'000'000'000));
+}
+TEST(parser_parse, nine_hundred_and_ninety_nine_billion_nine_hundred_and_ninety_nine_million_nine_hundred_and_ninety_nine_thousand_nine_hundred_and_ninety_nine) {
+    std::istringstream iss{ "nine hundred and ninety-nine billion nine hundred and ninety-nine million "
+        "nine hundred and ninety-nine thousand nine hundred and ninety-nine." };
+    EXPECT_EQ(std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse(), fmt::format("{}.", 999'999'999'999));
+}
 
 TEST(parser_parse, one_hundred_and_two) {
     std::istringstream iss{ "one hundred and two." };
@@ -378,3 +405,74 @@ TEST(parser_parse, one_thousand_million) {
     std::istringstream iss{ "one thousand million." };
     EXPECT_THROW((void) std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse(), invalid_token_error);
 }
+
+// Streaming parse
+TEST(parser_parse_streaming, empty_input_text) {
+    std::istringstream iss{ "" };
+    std::vector<std::string> sentences{};
+    std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse([&sentences](const std::string& sentence) {
+        sentences.push_back(sentence);
+    });
+    EXPECT_TRUE(sentences.empty());
+}
+TEST(parser_parse_streaming, three_sentences) {
+    std::istringstream iss{ "one. foo two.three" };
+    std::vector<std::string> sentences{};
+    std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse([&sentences](const std::string& sentence) {
+        sentences.push_back(sentence);
+    });
+    EXPECT_EQ(sentences, (std::vector<std::string>{ "1. ", "foo 2.", "3" }));
+}
+TEST(parser_parse_streaming, malformed_number_in_second_sentence) {
+    std::istringstream iss{ "one. one two." };
+    std::vector<std::string> sentences{};
+    EXPECT_THROW(std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse([&sentences](const std::string& sentence) {
+        sentences.push_back(sentence);
+    }), invalid_token_error);
+    EXPECT_EQ(sentences, (std::vector<std::string>{ "1. " }));
+}
+TEST(parser_parse_streaming, in_1_txt) {
+    fs::path input_file_path{ "../../res/in_1.txt" };
+    std::ifstream expected_output_ifs{ "../../res/out_1.txt" };
+    std::string expected_output_str{ std::istreambuf_iterator{ expected_output_ifs }, {} };
+    std::string output_str{};
+    std::make_unique<parser>(std::make_unique<file_reader>(input_file_path))->parse([&output_str](const std::string& sentence) {
+        output_str += sentence;
+    });
+    EXPECT_EQ(output_str, expected_output_str);
+}
+
+
+// Allocations
+// Sentence nodes are built in an arena, evaluated into a reused buffer, and tokenized by coroutine frames taken from a pool,
+// so a streaming parse only allocates a few times, while its buffers grow, no matter the number of sentences
+TEST(parser_parse_streaming, allocations) {
+    std::string input{};
+    std::string expected_output{};
+    corpus_generator{ { .seed = 3, .number_percent = 50 } }.generate(64 * 1024, input, expected_output);
+    auto sentences{ static_cast<size_t>(std::ranges::count(input, '.')) };
+    parser p{ std::make_unique<memory_reader>(input) };
+    std::string output{};
+    output.reserve(expected_output.size());
+    auto allocations{ allocation_counter::count_allocations([&p, &output]() {
+        p.parse([&output](const std::string& sentence) { output += sentence; });
+    }) };
+    EXPECT_EQ(output, expected_output);
+    EXPECT_GT(sentences, 200);
+    EXPECT_LT(allocations, 16);  // it was about 40 allocations per sentence before using an arena
+}
+
+// Streaming parse into a sink
+TEST(parser_parse_into, string) {
+    std::istringstream iss{ "one. foo two.three" };
+    std::string output{ "#" };
+    std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse_into(output);
+    EXPECT_EQ(output, "#1. foo 2.3");
+}
+TEST(parser_parse_into, output_writer) {
+    std::istringstream iss{ "one. foo two.three" };
+    std::ostringstream oss{};
+    stream_writer writer{ oss };
+    std::make_unique<parser>(std::make_unique<stream_reader>(iss))->parse_into(writer);
+    EXPECT_EQ(oss.str(), "1. foo 2.3");
+}
@@ -0,0 +1,131 @@
+#include "input_reader.h"
+#include "pipeline_converter.h"
+#include "read_file.h"
+#include "translator.h"
+
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <memory>  // make_unique
+#include <sstream>  // istringstream
+#include <stdexcept>  // runtime_error
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+    std::string serial_convert(std::string_view text) {
+        return translator{ std::make_unique<memory_reader>(text) }.translate();
+    }
+
+    std::string pipeline_convert(input_reader_up reader, size_t block_size, size_t blocks) {
+        std::string ret{};
+        pipeline_converter{ block_size, blocks }.convert(std::move(reader), [&ret](std::string_view block) {
+            ret += block;
+        });
+        return ret;
+    }
+    std::string pipeline_convert(std::string_view text, size_t block_size, size_t blocks) {
+        return pipeline_convert(std::make_unique<memory_reader>(text), block_size, blocks);
+    }
+}  // namespace
+
+
+TEST(pipeline_converter_convert, empty_input_text) {
+    EXPECT_EQ(pipeline_convert("", 16, 2), "");
+}
+TEST(pipeline_converter_convert, one_block) {
+    std::string_view text{ "one. foo two.three" };
+    EXPECT_EQ(pipeline_convert(text, 1024, 2), serial_convert(text));
+}
+TEST(pipeline_converter_convert, text_ending_with_a_period) {
+    std::string_view text{ "one. foo two." };
+    EXPECT_EQ(pipeline_convert(text, 1024, 2), serial_convert(text));
+}
+// Sentences, and number expressions, span one, two, or more blocks
+TEST(pipeline_converter_convert, many_blocks) {
+    std::string_view text{ "one. foo two.three. Twenty-one thousand and five. one hundred and one. foo\nbar. ninety-nine" };
+    for (size_t block_size{ 1 }; block_size < text.size(); ++block_size) {
+        EXPECT_EQ(pipeline_convert(text, block_size, 2), serial_convert(text));
+    }
+}
+TEST(pipeline_converter_convert, more_blocks_than_blocks_in_flight) {
+    std::string text{};
+    for (int i{ 0 }; i < 1000; ++i) {
+        text += "one million two hundred and three thousand and four. foo twenty-two. ";
+    }
+    EXPECT_EQ(pipeline_convert(text, 16, 2), serial_convert(text));
+    EXPECT_EQ(pipeline_convert(text, 4096, 8), serial_convert(text));
+}
+TEST(pipeline_converter_convert, stream_reader) {
+    std::string text{ "one. one hundred and one.\nninety-nine. two" };
+    std::istringstream iss{ text };
+    EXPECT_EQ(pipeline_convert(std::make_unique<stream_reader>(iss), 8, 2), serial_convert(text));
+}
+TEST(pipeline_converter_convert, malformed_number) {
+    std::string_view text{ "one. two. one two. three." };
+    std::string output{};
+    EXPECT_THROW(pipeline_converter(4, 2).convert(std::make_unique<memory_reader>(text), [&output](std::string_view block) {
+        output += block;
+    }), invalid_token_error);
+    EXPECT_EQ(output, "1. 2.");
+}
+TEST(pipeline_converter_convert, recover_from_malformed_sentences) {
+    std::string_view text{ "one. one two. three. four five. six." };
+    for (size_t block_size{ 1 }; block_size < text.size(); ++block_size) {
+        std::string output{};
+        std::vector<size_t> offsets{};
+        pipeline_converter(block_size, 3).convert(std::make_unique<memory_reader>(text),
+            [&output](std::string_view block) { output += block; },
+            [&offsets](const sentence_error& error) { offsets.push_back(error.offset); });
+        EXPECT_EQ(output, "1. one two. 3. four five. 6.");
+        EXPECT_EQ(offsets, (std::vector<size_t>{ 4, 20 }));
+    }
+}
+TEST(pipeline_converter_convert, recover_from_invalid_number_expressions) {
+    std::string_view text{ "one. one hundred hundred. five." };
+    for (size_t block_size{ 1 }; block_size < text.size(); ++block_size) {
+        std::string output{};
+        std::vector<sentence_error> errors{};
+        pipeline_converter(block_size, 3).convert(std::make_unique<memory_reader>(text),
+            [&output](std::string_view block) { output += block; },
+            [&errors](const sentence_error& error) { errors.push_back(error); });
+        EXPECT_EQ(output, "1. one hundred hundred. 5.");
+        ASSERT_EQ(errors.size(), 1);
+        EXPECT_EQ(errors[0].offset, 4);
+        EXPECT_EQ(errors[0].message, "invalid number expression: '100 100'");
+    }
+}
+TEST(pipeline_converter_convert, writer_error) {
+    std::string text{};
+    for (int i{ 0 }; i < 1000; ++i) {
+        text += "one. ";
+    }
+    int blocks_written{ 0 };
+    EXPECT_THROW(pipeline_converter(16, 2).convert(std::make_unique<memory_reader>(text), [&blocks_written](std::string_view) {
+        if (++blocks_written == 3) {
+            throw std::runtime_error{ "disk full" };
+        }
+    }), std::runtime_error);
+    EXPECT_EQ(blocks_written, 3);
+}
+TEST(pipeline_converter_convert, in_1_txt) {
+    auto input{ read_file("../../res/in_1.txt") };
+    EXPECT_EQ(pipeline_convert(input, 16, 4), read_file("../../res/out_1.txt"));
+}
+TEST(pipeline_converter_convert, in_2_txt) {
+    auto input{ read_file("../../res/in_2.txt") };
+    EXPECT_EQ(pipeline_convert(input, 16, 4), read_file("../../res/out_2.txt"));
+}
+
+// Counters
+TEST(pipeline_converter_get_counters, same_as_a_serial_conversion) {
+    std::string_view text{ "one. foo two.three. Twenty-one thousand and five. one hundred and one. foo\nbar. ninety-nine" };
+    translator t{ std::make_unique<memory_reader>(text) };
+    (void) t.translate();
+    pipeline_converter converter{ 16, 2 };
+    converter.convert(std::make_unique<memory_reader>(text), [](std::string_view) {});
+    EXPECT_EQ(converter.get_counters(), t.get_counters());
+}
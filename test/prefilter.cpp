@@ -0,0 +1,100 @@
+#include "prefilter.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <string_view>
+
+
+namespace {
+    // Reference implementation: split the text into words, and check each of them
+    size_t find_candidate_reference(std::string_view text, size_t pos) {
+        auto is_letter = [](char c) { return ('a' <= c and c <= 'z') or ('A' <= c and c <= 'Z'); };
+        while (pos < text.size()) {
+            if (is_letter(text[pos]) and (pos == 0 or not is_letter(text[pos - 1]))) {
+                auto end{ pos };
+                while (end < text.size() and is_letter(text[end])) {
+                    ++end;
+                }
+                if (prefilter::could_be_keyword(text[pos], end - pos)) {
+                    return pos;
+                }
+                pos = end;
+            } else {
+                ++pos;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    std::string get_random_text(std::mt19937& gen, size_t size) {
+        static const std::string_view alphabet{ "abcdefghijklmnopqrstuvwxyzNTOE \t\n-.,\xc3\xa9" };
+        std::uniform_int_distribution<size_t> dist{ 0, alphabet.size() - 1 };
+        std::string ret(size, ' ');
+        for (auto& c : ret) {
+            c = alphabet[dist(gen)];
+        }
+        return ret;
+    }
+
+    template <prefilter::isa_t Isa>
+    void check_against_reference() {
+        std::mt19937 gen{ 42 };
+        for (size_t size : { 0, 1, 15, 63, 64, 65, 127, 128, 200, 1000 }) {
+            for (int i{ 0 }; i < 20; ++i) {
+                auto text{ get_random_text(gen, size) };
+                for (size_t pos{ 0 }; pos <= text.size(); pos += 7) {
+                    EXPECT_EQ(prefilter::find_candidate<Isa>(text, pos), find_candidate_reference(text, pos));
+                }
+            }
+        }
+    }
+}  // namespace
+
+
+static_assert(prefilter::could_be_keyword('t', 3));  // ten, two
+static_assert(prefilter::could_be_keyword('B', 7));  // billion
+static_assert(not prefilter::could_be_keyword('t', 4));
+static_assert(not prefilter::could_be_keyword('x', 3));
+static_assert(not prefilter::could_be_keyword('-', 3));
+
+TEST(prefilter_find_candidate, empty_text) {
+    EXPECT_EQ(prefilter::find_candidate("", 0), std::string_view::npos);
+}
+TEST(prefilter_find_candidate, no_candidates) {
+    EXPECT_EQ(prefilter::find_candidate("A quick brown fox jumps over a lazy dog.", 0), std::string_view::npos);
+}
+TEST(prefilter_find_candidate, candidate_at_the_start) {
+    EXPECT_EQ(prefilter::find_candidate("Twenty dogs", 0), 0);
+}
+TEST(prefilter_find_candidate, candidate_that_is_not_a_keyword) {
+    EXPECT_EQ(prefilter::find_candidate("big fire", 0), 4);
+}
+TEST(prefilter_find_candidate, starting_in_the_middle_of_a_word) {
+    EXPECT_EQ(prefilter::find_candidate("xone one", 1), 5);
+}
+TEST(prefilter_find_candidate, candidate_after_a_block_boundary) {
+    std::string text(100, '.');
+    text += "hundred";
+    EXPECT_EQ(prefilter::find_candidate(text, 0), 100);
+}
+TEST(prefilter_find_candidate, word_across_a_block_boundary) {
+    std::string text(60, ' ');
+    text += "thousand thousands";
+    EXPECT_EQ(prefilter::find_candidate(text, 0), 60);
+    EXPECT_EQ(prefilter::find_candidate(text, 61), std::string_view::npos);
+}
+TEST(prefilter_find_candidate, scalar) {
+    check_against_reference<prefilter::isa_t::scalar>();
+}
+#if defined(WORD_CONVERTER_HAS_SSE2)
+TEST(prefilter_find_candidate, sse2) {
+    check_against_reference<prefilter::isa_t::sse2>();
+}
+#endif
+#if defined(__AVX2__)
+TEST(prefilter_find_candidate, avx2) {
+    check_against_reference<prefilter::isa_t::avx2>();
+}
+#endif
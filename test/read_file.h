@@ -0,0 +1,14 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>  // istreambuf_iterator
+#include <string>
+
+
+// Whole contents of a file, read in binary mode, so that line endings are compared as they were written
+// A file that cannot be read has no contents
+[[nodiscard]] inline std::string read_file(const std::filesystem::path& file_path) {
+    std::ifstream ifs{ file_path, std::ios::binary };
+    return { std::istreambuf_iterator<char>{ ifs }, std::istreambuf_iterator<char>{} };
+}
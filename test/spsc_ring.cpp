@@ -0,0 +1,83 @@
+#include "spsc_ring.h"
+
+#include <gtest/gtest.h>
+#include <thread>  // jthread
+#include <vector>
+
+
+TEST(spsc_ring, capacity_is_rounded_up_to_a_power_of_two) {
+    EXPECT_EQ(spsc_ring<int>{ 0 }.capacity(), 1);
+    EXPECT_EQ(spsc_ring<int>{ 3 }.capacity(), 4);
+    EXPECT_EQ(spsc_ring<int>{ 8 }.capacity(), 8);
+}
+TEST(spsc_ring, try_push_and_try_pop) {
+    spsc_ring<int> ring{ 2 };
+    EXPECT_TRUE(ring.empty());
+    int value{ 1 };
+    EXPECT_TRUE(ring.try_push(value));
+    value = 2;
+    EXPECT_TRUE(ring.try_push(value));
+    value = 3;
+    EXPECT_FALSE(ring.try_push(value));
+    EXPECT_FALSE(ring.empty());
+    EXPECT_TRUE(ring.try_pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(ring.try_pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(ring.try_pop(value));
+    EXPECT_TRUE(ring.empty());
+}
+TEST(spsc_ring, close) {
+    spsc_ring<int> ring{ 2 };
+    EXPECT_TRUE(ring.push(1));
+    ring.close();
+    EXPECT_TRUE(ring.closed());
+    EXPECT_FALSE(ring.push(2));
+    int value{};
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_FALSE(ring.pop(value));
+}
+TEST(spsc_ring, close_wakes_up_a_waiting_consumer) {
+    spsc_ring<int> ring{ 2 };
+    bool popped{ true };
+    {
+        std::jthread consumer{ [&ring, &popped]() {
+            int value{};
+            popped = ring.pop(value);
+        } };
+        ring.close();
+    }
+    EXPECT_FALSE(popped);
+}
+TEST(spsc_ring, close_wakes_up_a_waiting_producer) {
+    spsc_ring<int> ring{ 1 };
+    EXPECT_TRUE(ring.push(1));
+    bool pushed{ true };
+    {
+        std::jthread producer{ [&ring, &pushed]() { pushed = ring.push(2); } };
+        ring.close();
+    }
+    EXPECT_FALSE(pushed);
+}
+// The consumer gets every value, in order, although the ring is much smaller than the number of values
+TEST(spsc_ring, producer_and_consumer_threads) {
+    static constexpr int values{ 100'000 };
+    spsc_ring<int> ring{ 4 };
+    std::vector<int> popped{};
+    {
+        std::jthread consumer{ [&ring, &popped]() {
+            for (int value{}; ring.pop(value);) {
+                popped.push_back(value);
+            }
+        } };
+        for (int i{ 0 }; i < values; ++i) {
+            EXPECT_TRUE(ring.push(i));
+        }
+        ring.close();
+    }
+    ASSERT_EQ(popped.size(), values);
+    for (int i{ 0 }; i < values; ++i) {
+        EXPECT_EQ(popped[i], i);
+    }
+}
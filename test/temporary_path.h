@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <fmt/format.h>
+#include <string_view>
+#include <system_error>  // error_code
+
+#ifdef _WIN32
+#include <process.h>  // _getpid
+#else
+#include <unistd.h>  // getpid
+#endif
+
+
+// A path in the temporary directory, unique to the test process, e.g. for a file, a directory, or a socket
+// Nothing is created at that path, but whatever ends up there is removed when the path goes out of scope,
+// even if the test failed an assertion
+class temporary_path {
+    std::filesystem::path path_{};
+private:
+    [[nodiscard]] static int get_process_id() {
+#ifdef _WIN32
+        return ::_getpid();
+#else
+        return static_cast<int>(::getpid());
+#endif
+    }
+public:
+    explicit temporary_path(std::string_view name)
+        : path_{ std::filesystem::temp_directory_path() / fmt::format("word_converter_test_{}_{}", name, get_process_id()) }
+    {}
+    temporary_path(const temporary_path&) = delete;
+    temporary_path& operator=(const temporary_path&) = delete;
+    ~temporary_path() {
+        std::error_code ec{};
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    [[nodiscard]] const std::filesystem::path& get() const { return path_; }
+    operator const std::filesystem::path&() const { return path_; }
+    friend std::filesystem::path operator/(const temporary_path& lhs, const std::filesystem::path& rhs) { return lhs.path_ / rhs; }
+};
@@ -0,0 +1,109 @@
+#include "input_reader.h"
+#include "output_writer.h"
+#include "parallel_converter.h"
+#include "pipeline_converter.h"
+#include "trace.h"
+#include "translator.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory>  // make_unique
+#include <sstream>  // ostringstream
+#include <string>
+#include <string_view>
+#include <thread>  // jthread
+
+
+namespace {
+    std::string to_json(const trace_recorder& recorder) {
+        std::ostringstream oss{};
+        stream_writer writer{ oss };
+        recorder.write(writer);
+        writer.flush();
+        return oss.str();
+    }
+}  // namespace
+
+
+TEST(trace_span, not_recorded_without_a_recorder) {
+    EXPECT_EQ(trace_recorder::get_current(), nullptr);
+    { trace_span span{ "nothing" }; }
+    trace_recorder recorder{};
+    EXPECT_EQ(recorder.get_event_count(), 0);
+}
+TEST(trace_span, recorded_while_a_recorder_is_alive) {
+    {
+        trace_recorder recorder{};
+        EXPECT_EQ(trace_recorder::get_current(), &recorder);
+        { trace_span span{ "outer" }; trace_span inner{ "inner", 42 }; }
+        EXPECT_EQ(recorder.get_event_count(), 2);
+        auto json{ to_json(recorder) };
+        EXPECT_THAT(json, ::testing::HasSubstr(R"("name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"thread 1"})"));
+        EXPECT_THAT(json, ::testing::ContainsRegex(R"(\{"name":"outer","cat":"word_converter","ph":"X","pid":1,"tid":1,"ts":[0-9]+\.[0-9]{3},"dur":[0-9]+\.[0-9]{3}\})"));
+        EXPECT_THAT(json, ::testing::ContainsRegex(R"(\{"name":"inner",.*"args":\{"offset":42\}\})"));
+        EXPECT_THAT(json, ::testing::HasSubstr(R"("otherData":{"dropped_events":0})"));
+    }
+    EXPECT_EQ(trace_recorder::get_current(), nullptr);
+}
+TEST(trace_recorder, one_tid_per_thread) {
+    trace_recorder recorder{};
+    trace_recorder::set_thread_name("main");
+    { trace_span span{ "main span" }; }
+    {
+        std::jthread t1{ []() { trace_recorder::set_thread_name("worker"); trace_span span{ "worker span" }; } };
+        std::jthread t2{ []() { trace_recorder::set_thread_name("worker"); trace_span span{ "worker span" }; } };
+    }
+    auto json{ to_json(recorder) };
+    EXPECT_THAT(json, ::testing::HasSubstr(R"("tid":1,"args":{"name":"main"})"));
+    EXPECT_THAT(json, ::testing::HasSubstr(R"("tid":2,"args":{"name":"worker"})"));
+    EXPECT_THAT(json, ::testing::HasSubstr(R"("tid":3,"args":{"name":"worker"})"));
+    EXPECT_EQ(recorder.get_event_count(), 3);
+}
+TEST(trace_recorder, drops_events_beyond_the_maximum) {
+    trace_recorder recorder{ 2 };
+    for (int i{ 0 }; i < 5; ++i) {
+        trace_span span{ "span" };
+    }
+    EXPECT_EQ(recorder.get_event_count(), 2);
+    EXPECT_EQ(recorder.get_dropped_event_count(), 3);
+    EXPECT_THAT(to_json(recorder), ::testing::HasSubstr(R"("otherData":{"dropped_events":3})"));
+}
+TEST(trace_recorder, a_new_recorder_starts_with_new_threads) {
+    { trace_recorder recorder{}; trace_recorder::set_thread_name("first"); }
+    trace_recorder recorder{};
+    { trace_span span{ "span" }; }
+    EXPECT_THAT(to_json(recorder), ::testing::HasSubstr(R"("tid":1,"args":{"name":"thread 1"})"));
+}
+
+// The translator records the read and the translation of every sentence, but only if the trace spans are compiled in
+TEST(trace_recorder, translator_spans) {
+    trace_recorder recorder{};
+    (void) translator{ std::make_unique<memory_reader>("one. two. three") }.translate();
+    auto json{ to_json(recorder) };
+#ifdef WORD_CONVERTER_TRACING
+    EXPECT_THAT(json, ::testing::HasSubstr(R"("name":"read")"));
+    EXPECT_THAT(json, ::testing::ContainsRegex(R"("name":"translate",.*"args":\{"offset":4\})"));
+    EXPECT_EQ(recorder.get_event_count(), 6);
+#else
+    EXPECT_EQ(recorder.get_event_count(), 0);
+#endif
+}
+// Converters running on more than one thread record the spans of every thread under its own thread id
+TEST(trace_recorder, pipeline_and_parallel_converter_threads) {
+    std::string text{};
+    for (int i{ 0 }; i < 100; ++i) {
+        text += "one hundred and one. foo twenty-two. ";
+    }
+    trace_recorder recorder{};
+    pipeline_converter{ 64, 2 }.convert(std::make_unique<memory_reader>(text), [](std::string_view) {});
+    parallel_converter{ 2, 64 }.convert(text, [](const std::string&) {});
+    auto json{ to_json(recorder) };
+#ifdef WORD_CONVERTER_TRACING
+    EXPECT_THAT(json, ::testing::ContainsRegex(R"("tid":[0-9]+,"args":\{"name":"reader"\})"));
+    EXPECT_THAT(json, ::testing::ContainsRegex(R"("tid":[0-9]+,"args":\{"name":"writer"\})"));
+    EXPECT_THAT(json, ::testing::ContainsRegex(R"("tid":[0-9]+,"args":\{"name":"worker"\})"));
+    EXPECT_THAT(json, ::testing::HasSubstr(R"("name":"chunk")"));
+#else
+    EXPECT_EQ(recorder.get_event_count(), 0);
+#endif
+}
@@ -0,0 +1,337 @@
+#include "allocation_counter.h"
+#include "corpus_generator.h"
+#include "input_reader.h"
+#include "lexer.h"
+#include "output_writer.h"
+#include "parser.h"
+#include "read_file.h"
+#include "translator.h"
+
+#include <algorithm>  // count
+#include <array>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sstream>  // istringstream, ostringstream
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+namespace {
+    std::string translate(std::string_view text) {
+        return std::make_unique<translator>(std::make_unique<memory_reader>(text))->translate();
+    }
+
+    std::string parse(std::string_view text) {
+        return std::make_unique<parser>(std::make_unique<memory_reader>(text))->parse();
+    }
+}  // namespace
+
+
+// Same output as the parser
+TEST(translator_translate, same_output_as_parser) {
+    static constexpr std::array inputs{
+        "",
+        ". foo.",
+        ". one.",
+        ".",
+        "..",
+        "ZERO.",
+        "Zero.",
+        "foo one meh two blah.",
+        "foo one meh two.",
+        "foo one meh.",
+        "foo one.",
+        "foo",
+        "foo.",
+        "foo..",
+        "foo\nmeh",
+        "foo\nmeh.",
+        "foo\nmeh.blah",
+        "nine hundred and ninety nine million nine hundred and ninety nine thousand nine hundred and ninety nine.",
+        "nine hundred and ninety nine million.",
+        "nine hundred and ninety nine thousand.",
+        "nine hundred and ninety nine.",
+        "nine hundred and ninety-nine million.",
+        "nine hundred and ninety-nine thousand.",
+        "nine hundred and ninety-nine.",
+        "nine hundred and ninety.",
+        "nine hundred and one.",
+        "nine hundred million.",
+        "nine hundred thousand.",
+        "nine hundred.",
+        "nine million.",
+        "nine thousand.",
+        "nine.",
+        "nineteen.",
+        "ninety nine.",
+        "ninety one.",
+        "ninety-nine.",
+        "ninety-one.",
+        "ninety.",
+        "one BILLION.",
+        "one and two.",
+        "one billion.",
+        "one foo.",
+        "one hundred and ninety nine.",
+        "one hundred and ninety-nine.",
+        "one hundred and ninety.",
+        "one hundred and one.",
+        "one hundred and three and two.",
+        "one hundred and twenty three.",
+        "one hundred and twenty-three.",
+        "one hundred and two and three.",
+        "one hundred and two.",
+        "one hundred, and two.",
+        "one hundred.",
+        "one million and twenty three.",
+        "one million and twenty-three.",
+        "one million and two.",
+        "one million two hundred and three.",
+        "one million two thousand and three.",
+        "one million two thousand three hundred and four.",
+        "one million.",
+        "one thousand and twenty three.",
+        "one thousand and twenty-three.",
+        "one thousand and two.",
+        "one thousand two hundred and three.",
+        "one thousand.",
+        "one. foo two.three",
+        "one.",
+        "one..",
+        "seven million five hundred and twelve thousand one hundred and forty five.",
+        "ten.",
+        "three million eight hundred thousand and eighteen.",
+        "three million six hundred and three thousand eight hundred and two.",
+        "twenty nine.",
+        "twenty one.",
+        "twenty-ONE.",
+        "twenty-One.",
+        "twenty-nine.",
+        "twenty-one.",
+        "twenty.",
+        "two and one.",
+        "zero.",
+        "one thousand and foo.",
+        "twenty- one. twenty -one.",
+        "one  \t foo.",
+        "Two hundred and. one, two; three.",
+        "one hundred and  \n foo"
+    };
+    for (std::string_view input : inputs) {
+        EXPECT_EQ(translate(input), parse(input)) << "input: '" << input << "'";
+    }
+}
+TEST(translator_translate, same_output_as_parser_on_a_generated_corpus) {
+    for (auto max_magnitude : { magnitude_t::hundreds, magnitude_t::thousands, magnitude_t::millions, magnitude_t::billions }) {
+        std::string input{};
+        std::string expected_output{};
+        corpus_generator{ { .seed = 5, .number_percent = 50, .max_magnitude = max_magnitude } }.generate(64 * 1024, input, expected_output);
+        EXPECT_EQ(translate(input), parse(input));
+        EXPECT_EQ(translate(input), expected_output);
+    }
+}
+
+// Conversions
+TEST(translator_translate, empty_input_text) {
+    EXPECT_EQ(translate(""), "");
+}
+TEST(translator_translate, text) {
+    EXPECT_EQ(translate("foo\nmeh.blah"), "foo\nmeh.blah");
+}
+TEST(translator_translate, number_expressions) {
+    EXPECT_EQ(translate("Three million six hundred and three thousand eight hundred and two. twenty-One foo."), "3603802. 21 foo.");
+}
+TEST(translator_translate, billions) {
+    EXPECT_EQ(translate("nine hundred billion. nine hundred and ninety-nine billion and one."), "900000000000. 999000000001.");
+}
+TEST(translator_translate, number_expression_ending_in_and) {
+    EXPECT_EQ(translate("one thousand and foo."), "1000 foo.");
+}
+TEST(translator_translate, in_1_txt) {
+    EXPECT_EQ(std::make_unique<translator>(std::make_unique<file_reader>("../../res/in_1.txt"))->translate(), read_file("../../res/out_1.txt"));
+}
+TEST(translator_translate, in_2_txt) {
+    EXPECT_EQ(std::make_unique<translator>(std::make_unique<file_reader>("../../res/in_2.txt"))->translate(), read_file("../../res/out_2.txt"));
+}
+
+// Malformed numbers
+TEST(translator_translate, number_number) {
+    EXPECT_THROW((void) translate("one two."), invalid_token_error);
+}
+TEST(translator_translate, one_hundred_two_hundred) {
+    EXPECT_THROW((void) translate("one hundred two hundred."), invalid_token_error);
+}
+TEST(translator_translate, one_thousand_million) {
+    EXPECT_THROW((void) translate("one thousand million."), invalid_token_error);
+}
+TEST(translator_translate, one_hundred_hundred) {
+    EXPECT_THROW((void) translate("one hundred hundred."), invalid_number_expression_error);
+}
+TEST(translator_translate, error_reports_the_sentence_translated_so_far) {
+    try {
+        (void) translate("one. foo one two.");
+        FAIL();
+    } catch (const invalid_token_error& ex) {
+        EXPECT_EQ(std::string{ ex.what() }, "invalid token: '(two_to_nine, 'two')', while parsing node: ' foo 1 '");
+    }
+}
+
+// Streaming translation
+TEST(translator_translate_streaming, three_sentences) {
+    std::istringstream iss{ "one. foo two.three" };
+    std::vector<std::string> sentences{};
+    std::make_unique<translator>(std::make_unique<stream_reader>(iss))->translate([&sentences](const std::string& sentence) {
+        sentences.push_back(sentence);
+    });
+    EXPECT_EQ(sentences, (std::vector<std::string>{ "1.", " foo 2.", "3" }));
+}
+TEST(translator_translate_streaming, malformed_number_in_second_sentence) {
+    std::istringstream iss{ "one. one two." };
+    std::vector<std::string> sentences{};
+    EXPECT_THROW(std::make_unique<translator>(std::make_unique<stream_reader>(iss))->translate([&sentences](const std::string& sentence) {
+        sentences.push_back(sentence);
+    }), invalid_token_error);
+    EXPECT_EQ(sentences, (std::vector<std::string>{ "1." }));
+}
+// A sentence is handed over as soon as its period is read, before the input is read any further
+// e.g. a sentence typed into the standard input is output without waiting for the next one
+TEST(translator_translate_streaming, sentence_is_handed_over_before_reading_the_next_one) {
+    struct counting_reader : public memory_reader {
+        explicit counting_reader(std::string_view text, size_t& reads) : memory_reader{ text }, reads_{ reads } {}
+        std::string_view read() override { ++reads_; return memory_reader::read(); }
+    private:
+        size_t& reads_;
+    };
+    size_t reads{ 0 };
+    std::vector<size_t> reads_per_sentence{};
+    std::make_unique<translator>(std::make_unique<counting_reader>("one. two. three.", reads))->translate(
+        [&reads, &reads_per_sentence](const std::string&) { reads_per_sentence.push_back(reads); });
+    EXPECT_EQ(reads_per_sentence, (std::vector<size_t>{ 1, 2, 3 }));
+}
+// Recovery mode
+namespace {
+    struct recovered_translation {
+        std::string output{};
+        std::vector<sentence_error> errors{};
+    };
+    recovered_translation translate_with_recovery(input_reader_up reader) {
+        recovered_translation ret{};
+        translator{ std::move(reader) }.translate_into(ret.output,
+            [&ret](const sentence_error& error) { ret.errors.push_back(error); });
+        return ret;
+    }
+}  // namespace
+TEST(translator_translate_recovering, well_formed_text) {
+    auto [output, errors] { translate_with_recovery(std::make_unique<memory_reader>("one. foo two.three")) };
+    EXPECT_EQ(output, "1. foo 2.3");
+    EXPECT_TRUE(errors.empty());
+}
+TEST(translator_translate_recovering, malformed_sentence_is_copied_through) {
+    auto [output, errors] { translate_with_recovery(std::make_unique<memory_reader>("One. Two one thousand three, and four.\nFive.")) };
+    EXPECT_EQ(output, "1. Two one thousand three, and four.\n5.");
+    ASSERT_EQ(errors.size(), 1);
+    EXPECT_EQ(errors[0].offset, 4);
+    EXPECT_EQ(errors[0].sentence, " Two one thousand three, and four.");
+    EXPECT_EQ(errors[0].message, "invalid token: '(one, 'one')', while parsing node: ' 2 '");
+    EXPECT_EQ(fmt::format("{}", errors[0]),
+        "4: invalid token: '(one, 'one')', while parsing node: ' 2 ', in sentence: ' Two one thousand three, and four.'");
+}
+TEST(translator_translate_recovering, invalid_number_expression) {
+    auto [output, errors] { translate_with_recovery(std::make_unique<memory_reader>("one. one hundred hundred. five.")) };
+    EXPECT_EQ(output, "1. one hundred hundred. 5.");
+    ASSERT_EQ(errors.size(), 1);
+    EXPECT_EQ(errors[0].offset, 4);
+    EXPECT_EQ(errors[0].sentence, " one hundred hundred.");
+    EXPECT_EQ(errors[0].message, "invalid number expression: '100 100'");
+}
+TEST(translator_translate_recovering, malformed_sentences_in_a_row) {
+    std::istringstream iss{ "one two. three four. five." };
+    auto [output, errors] { translate_with_recovery(std::make_unique<stream_reader>(iss)) };
+    EXPECT_EQ(output, "one two. three four. 5.");
+    ASSERT_EQ(errors.size(), 2);
+    EXPECT_EQ(errors[0].offset, 0);
+    EXPECT_EQ(errors[1].offset, 8);
+    EXPECT_EQ(errors[1].sentence, " three four.");
+}
+TEST(translator_translate_recovering, malformed_last_sentence_without_a_period) {
+    auto [output, errors] { translate_with_recovery(std::make_unique<memory_reader>("one.\none two")) };
+    EXPECT_EQ(output, "1.\none two");
+    ASSERT_EQ(errors.size(), 1);
+    EXPECT_EQ(errors[0].offset, 4);
+    EXPECT_TRUE(fmt::format("{}", errors[0]).ends_with("in sentence: '\\none two'"));
+}
+TEST(translator_translate_recovering, same_output_as_input_for_malformed_sentences_of_a_generated_corpus) {
+    std::string input{};
+    std::string expected_output{};
+    corpus_generator generator{ { .seed = 5, .number_percent = 30 } };
+    for (int i{ 0 }; i < 100; ++i) {
+        generator.next_sentence(input, expected_output);
+        std::string malformed{ " One two three." };
+        input += malformed;
+        expected_output += malformed;
+    }
+    auto [output, errors] { translate_with_recovery(std::make_unique<memory_reader>(input)) };
+    EXPECT_EQ(output, expected_output);
+    ASSERT_EQ(errors.size(), 100);
+    for (const auto& error : errors) {
+        EXPECT_EQ(input.substr(error.offset, error.sentence.size()), error.sentence);
+    }
+}
+TEST(translator_translate_into, output_writer) {
+    std::istringstream iss{ "one. foo two.three" };
+    std::ostringstream oss{};
+    stream_writer writer{ oss };
+    std::make_unique<translator>(std::make_unique<stream_reader>(iss))->translate_into(writer);
+    EXPECT_EQ(oss.str(), "1. foo 2.3");
+}
+
+// Allocations
+// No AST is built, and tokenizer coroutine frames are taken from a pool, so a translation only allocates while its buffers grow
+TEST(translator_translate_streaming, allocations) {
+    std::string input{};
+    std::string expected_output{};
+    corpus_generator{ { .seed = 3, .number_percent = 50 } }.generate(64 * 1024, input, expected_output);
+    auto sentences{ static_cast<size_t>(std::ranges::count(input, '.')) };
+    translator t{ std::make_unique<memory_reader>(input) };
+    std::string output{};
+    output.reserve(expected_output.size());
+    auto allocations{ allocation_counter::count_allocations([&t, &output]() {
+        t.translate([&output](const std::string& sentence) { output += sentence; });
+    }) };
+    EXPECT_EQ(output, expected_output);
+    EXPECT_GT(sentences, 200);
+    EXPECT_LT(allocations, 16);
+}
+
+// Counters
+TEST(translator_get_counters, empty_input_text) {
+    translator t{ std::make_unique<memory_reader>("") };
+    (void) t.translate();
+    EXPECT_EQ(t.get_counters(), translation_counters{});
+}
+TEST(translator_get_counters, sentences_tokens_and_number_expressions) {
+    std::string_view text{ "Three million six hundred and three thousand eight hundred and two. twenty-One foo.\n" };
+    translator t{ std::make_unique<memory_reader>(text) };
+    (void) t.translate();
+    lexer l{ std::make_unique<memory_reader>(text) };
+    while (l.get_current_lexeme() != lexeme_t::end) {
+        l.advance_to_next_token();
+    }
+    EXPECT_EQ(t.get_counters(), (translation_counters{ 3, l.get_token_count(), 2 }));
+}
+TEST(translator_get_counters, malformed_sentences_are_counted_but_not_their_number_expressions) {
+    translator t{ std::make_unique<memory_reader>("one two. three.") };
+    t.translate([](const std::string&) {}, [](const sentence_error&) {});
+    EXPECT_EQ(t.get_counters().sentences, 2);
+    EXPECT_EQ(t.get_counters().number_expressions, 1);
+}
+TEST(translator_get_counters, reset) {
+    translator t{ std::make_unique<memory_reader>("one. two.") };
+    (void) t.translate();
+    t.reset(std::make_unique<memory_reader>("three"));
+    (void) t.translate();
+    EXPECT_EQ(t.get_counters(), (translation_counters{ 1, 1, 1 }));
+}
@@ -0,0 +1,103 @@
+#include "corpus_generator.h"
+#include "word_converter.h"
+
+#include <array>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <thread>  // jthread
+#include <vector>
+
+
+extern "C" wc_status convert_from_c(const char* text, char* output, size_t output_size);
+
+
+namespace {
+    [[nodiscard]] std::string_view to_string_view(const wc_buffer& buffer) {
+        return { buffer.data, buffer.size };
+    }
+}  // namespace
+
+
+TEST(wc_convert, text) {
+    wc_context* context{ wc_context_create() };
+    wc_buffer out{};
+    std::string_view in{ "I have twenty-one apples. And one hundred and five pears.\n" };
+    EXPECT_EQ(wc_convert(context, in.data(), in.size(), &out), WC_OK);
+    EXPECT_EQ(to_string_view(out), "I have 21 apples. And 105 pears.\n");
+    EXPECT_STREQ(wc_last_error(context), "");
+    wc_context_destroy(context);
+}
+TEST(wc_convert, empty_text) {
+    wc_context* context{ wc_context_create() };
+    wc_buffer out{};
+    EXPECT_EQ(wc_convert(context, nullptr, 0, &out), WC_OK);
+    EXPECT_EQ(out.size, 0);
+    wc_context_destroy(context);
+}
+TEST(wc_convert, context_is_reused) {
+    wc_context* context{ wc_context_create() };
+    wc_buffer out{};
+    EXPECT_EQ(wc_convert(context, "one.", 4, &out), WC_OK);
+    EXPECT_EQ(to_string_view(out), "1.");
+    EXPECT_EQ(wc_convert(context, "one thousand and two", 20, &out), WC_OK);
+    EXPECT_EQ(to_string_view(out), "1002");
+    wc_context_destroy(context);
+}
+TEST(wc_convert, invalid_text) {
+    wc_context* context{ wc_context_create() };
+    wc_buffer out{};
+    EXPECT_EQ(wc_convert(context, "one two.", 8, &out), WC_INVALID_TEXT);
+    EXPECT_EQ(out.data, nullptr);
+    EXPECT_EQ(out.size, 0);
+    EXPECT_STREQ(wc_last_error(context), "invalid token: '(two_to_nine, 'two')', while parsing node: '1 '");
+    EXPECT_EQ(wc_convert(context, "three.", 6, &out), WC_OK);
+    EXPECT_EQ(to_string_view(out), "3.");
+    EXPECT_STREQ(wc_last_error(context), "");
+    wc_context_destroy(context);
+}
+TEST(wc_convert, invalid_arguments) {
+    wc_buffer out{};
+    EXPECT_EQ(wc_convert(nullptr, "one", 3, nullptr), WC_INVALID_ARGUMENT);
+    EXPECT_EQ(wc_convert(nullptr, nullptr, 3, &out), WC_INVALID_ARGUMENT);
+}
+TEST(wc_convert, thread_context) {
+    wc_buffer out{};
+    EXPECT_EQ(wc_convert(nullptr, "one two.", 8, &out), WC_INVALID_TEXT);
+    EXPECT_STRNE(wc_last_error(nullptr), "");
+    EXPECT_EQ(wc_convert(nullptr, "twenty-two.", 11, &out), WC_OK);
+    EXPECT_EQ(to_string_view(out), "22.");
+    EXPECT_STREQ(wc_last_error(nullptr), "");
+}
+TEST(wc_convert, thread_contexts_are_independent) {
+    static constexpr size_t threads_count{ 4 };
+    std::array<std::string, threads_count> inputs{};
+    std::array<std::string, threads_count> expected_outputs{};
+    std::array<std::string, threads_count> outputs{};
+    for (size_t i{ 0 }; i < threads_count; ++i) {
+        corpus_generator{ { .seed = i, .number_percent = 50 } }.generate(16 * 1024, inputs[i], expected_outputs[i]);
+    }
+    {
+        std::vector<std::jthread> threads{};
+        for (size_t i{ 0 }; i < threads_count; ++i) {
+            threads.emplace_back([&inputs, &outputs, i]() {
+                wc_buffer out{};
+                if (wc_convert(nullptr, inputs[i].data(), inputs[i].size(), &out) == WC_OK) {
+                    outputs[i] = to_string_view(out);
+                }
+            });
+        }
+    }
+    EXPECT_EQ(outputs, expected_outputs);
+}
+TEST(wc_convert, from_c) {
+    std::array<char, 64> output{};
+    EXPECT_EQ(convert_from_c("Nine hundred and ninety-nine.", output.data(), output.size()), WC_OK);
+    EXPECT_STREQ(output.data(), "999.");
+}
+
+TEST(wc_status_name, names) {
+    EXPECT_STREQ(wc_status_name(WC_OK), "WC_OK");
+    EXPECT_STREQ(wc_status_name(WC_INVALID_TEXT), "WC_INVALID_TEXT");
+    EXPECT_STREQ(wc_status_name(static_cast<wc_status>(42)), "unknown status");
+}
@@ -0,0 +1,19 @@
+/* Compiled as C, to check that the C API can be used from C programs */
+#include "word_converter.h"
+
+#include <string.h>  /* memcpy */
+
+
+/* Converts a null-terminated text into a null-terminated output, with a context of its own */
+wc_status convert_from_c(const char* text, char* output, size_t output_size) {
+    wc_buffer buffer = { NULL, 0 };
+    wc_context* context = wc_context_create();
+    wc_status status = wc_convert(context, text, strlen(text), &buffer);
+    if (status == WC_OK) {
+        size_t size = buffer.size < output_size - 1 ? buffer.size : output_size - 1;
+        memcpy(output, buffer.data, size);
+        output[size] = '\0';
+    }
+    wc_context_destroy(context);
+    return status;
+}
@@ -0,0 +1,48 @@
+#include "work_stealing_pool.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <latch>
+#include <stdexcept>  // runtime_error
+#include <vector>
+
+
+TEST(work_stealing_pool_run, no_tasks) {
+    EXPECT_NO_THROW(work_stealing_pool{ 4 }.run({}));
+}
+TEST(work_stealing_pool_run, every_task_runs_once) {
+    for (size_t workers : { 1, 2, 3, 8 }) {
+        std::vector<std::atomic<int>> counters(100);
+        std::vector<work_stealing_pool::task_t> tasks{};
+        for (auto& counter : counters) {
+            tasks.emplace_back([&counter]() { ++counter; });
+        }
+        work_stealing_pool{ workers }.run(std::move(tasks));
+        for (const auto& counter : counters) {
+            EXPECT_EQ(counter, 1);
+        }
+    }
+}
+TEST(work_stealing_pool_run, tasks_of_a_busy_worker_are_stolen) {
+    // Task 0 is dealt to the first worker, and only finishes once all the other tasks have finished
+    // Half of those other tasks are dealt to the first worker too, so they have to be stolen by the second worker
+    const size_t number_of_tasks{ 10 };
+    std::latch others_done{ number_of_tasks - 1 };
+    std::vector<work_stealing_pool::task_t> tasks{};
+    tasks.emplace_back([&others_done]() { others_done.wait(); });
+    for (size_t i{ 1 }; i < number_of_tasks; ++i) {
+        tasks.emplace_back([&others_done]() { others_done.count_down(); });
+    }
+    work_stealing_pool{ 2 }.run(std::move(tasks));
+    EXPECT_TRUE(others_done.try_wait());
+}
+TEST(work_stealing_pool_run, throwing_task) {
+    std::atomic<int> counter{};
+    std::vector<work_stealing_pool::task_t> tasks{};
+    tasks.emplace_back([]() { throw std::runtime_error{ "blah" }; });
+    for (int i{ 0 }; i < 10; ++i) {
+        tasks.emplace_back([&counter]() { ++counter; });
+    }
+    EXPECT_THROW(work_stealing_pool{ 3 }.run(std::move(tasks)), std::runtime_error);
+    EXPECT_EQ(counter, 10);
+}
@@ -0,0 +1,173 @@
+#include "command_line_parser.h"  // invalid_argument_error, invalid_number_of_arguments_error, missing_argument_error
+#include "corpus_generator.h"
+#include "output_writer.h"  // could_not_create_file_error
+
+#include <charconv>  // from_chars
+#include <cstdint>  // uint64_t
+#include <exception>
+#include <filesystem>
+#include <fmt/ostream.h>
+#include <fstream>
+#include <iostream>  // cout
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // errc
+
+namespace fs = std::filesystem;
+
+
+struct generator_options {
+    fs::path output_file{};
+    size_t size{ 1024 * 1024 };
+    corpus_options corpus{};
+};
+
+
+void print_usage(std::ostream& os) {
+    fmt::print(os, "Usage:\n");
+    fmt::print(os, "\tword_converter_corpus_generator -o <OUTPUT_FILE_PATH> [-s <SIZE>] [-r <SEED>] [-w <WORDS_PER_SENTENCE>]"
+        " [-n <NUMBERS_PERCENT>] [-m <MAX_MAGNITUDE>]\n");
+    fmt::print(os, "Where:\n");
+    fmt::print(os, "\tOUTPUT_FILE_PATH    Path to the generated text file.\n");
+    fmt::print(os, "\t                    The expected conversion is written next to it, e.g. corpus.expected.txt for corpus.txt.\n");
+    fmt::print(os, "\tSIZE                Size of the generated text, in bytes, or with a K, M, or G suffix. Defaults to 1M.\n");
+    fmt::print(os, "\tSEED                Seed of the random generator. Defaults to 0.\n");
+    fmt::print(os, "\tWORDS_PER_SENTENCE  Number of words per sentence. Defaults to 12.\n");
+    fmt::print(os, "\tNUMBERS_PERCENT     Chance of a word being a number expression, from 0 to 100. Defaults to 10.\n");
+    fmt::print(os, "\tMAX_MAGNITUDE       Biggest magnitude of number expressions: hundreds, thousands, millions, or billions.\n");
+    fmt::print(os, "\t                    Defaults to billions.\n");
+    fmt::print(os, "Example:\n");
+    fmt::print(os, "\tword_converter_corpus_generator -o corpus.txt -s 1G -r 42 -n 50\n");
+}
+
+
+[[nodiscard]] uint64_t parse_number(std::string_view value, uint64_t max) {
+    uint64_t ret{};
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), ret);
+    if (ec != std::errc{} or ptr != value.data() + value.size() or ret > max) {
+        throw invalid_argument_error{ std::string{ value } };
+    }
+    return ret;
+}
+
+
+[[nodiscard]] size_t parse_size(std::string_view value) {
+    uint64_t multiplier{ 1 };
+    if (not value.empty()) {
+        switch (value.back()) {
+            case 'K': multiplier = uint64_t{ 1 } << 10; break;
+            case 'M': multiplier = uint64_t{ 1 } << 20; break;
+            case 'G': multiplier = uint64_t{ 1 } << 30; break;
+            default: break;
+        }
+    }
+    if (multiplier != 1) {
+        value.remove_suffix(1);
+    }
+    return static_cast<size_t>(parse_number(value, uint64_t{ 1 } << 40) * multiplier);
+}
+
+
+[[nodiscard]] magnitude_t parse_magnitude(const std::string& value) {
+    if (value == "hundreds") { return magnitude_t::hundreds; }
+    if (value == "thousands") { return magnitude_t::thousands; }
+    if (value == "millions") { return magnitude_t::millions; }
+    if (value == "billions") { return magnitude_t::billions; }
+    throw invalid_argument_error{ value };
+}
+
+
+// Options come in pairs, an option name followed by its value, in any order
+[[nodiscard]] generator_options parse_options(int argc, const char** argv) {
+    generator_options ret{};
+    if (argc == 1) {
+        throw invalid_number_of_arguments_error{ argc };
+    }
+    bool has_output_file{ false };
+    for (int i{ 1 }; i < argc; i += 2) {
+        std::string option{ argv[i] };
+        if (i + 1 == argc) {
+            throw invalid_number_of_arguments_error{ argc };
+        }
+        std::string value{ argv[i + 1] };
+        if (option == "-o") {
+            ret.output_file = value;
+            has_output_file = true;
+        } else if (option == "-s") {
+            ret.size = parse_size(value);
+        } else if (option == "-r") {
+            ret.corpus.seed = parse_number(value, UINT64_MAX);
+        } else if (option == "-w") {
+            ret.corpus.words_per_sentence = static_cast<size_t>(parse_number(value, 1'000));
+        } else if (option == "-n") {
+            ret.corpus.number_percent = static_cast<int>(parse_number(value, 100));
+        } else if (option == "-m") {
+            ret.corpus.max_magnitude = parse_magnitude(value);
+        } else {
+            throw invalid_argument_error{ option };
+        }
+    }
+    if (not has_output_file) {
+        throw missing_argument_error{ "-o" };
+    }
+    if (ret.corpus.words_per_sentence == 0) {
+        throw invalid_argument_error{ "0" };
+    }
+    return ret;
+}
+
+
+// E.g. corpus.expected.txt for corpus.txt
+[[nodiscard]] fs::path get_expected_output_file(const fs::path& output_file) {
+    auto ret{ output_file };
+    ret.replace_filename(output_file.stem().string() + ".expected" + output_file.extension().string());
+    return ret;
+}
+
+
+// Text is generated and written out in blocks, so that the memory used does not depend on the size of the text
+void generate(const generator_options& options) {
+    static constexpr size_t block_size{ 1024 * 1024 };
+    auto expected_output_file{ get_expected_output_file(options.output_file) };
+    std::ofstream input_ofs{ options.output_file, std::ios::binary };
+    if (not input_ofs) {
+        throw could_not_create_file_error{ options.output_file };
+    }
+    std::ofstream expected_output_ofs{ expected_output_file, std::ios::binary };
+    if (not expected_output_ofs) {
+        throw could_not_create_file_error{ expected_output_file };
+    }
+
+    corpus_generator generator{ options.corpus };
+    std::string input{};
+    std::string expected_output{};
+    size_t written{ 0 };
+    while (written < options.size) {
+        input.clear();
+        expected_output.clear();
+        while (input.size() < block_size and written + input.size() < options.size) {
+            generator.next_sentence(input, expected_output);
+        }
+        input_ofs.write(input.data(), static_cast<std::streamsize>(input.size()));
+        expected_output_ofs.write(expected_output.data(), static_cast<std::streamsize>(expected_output.size()));
+        written += input.size();
+    }
+}
+
+
+int main_impl(std::ostream& os, int argc, const char** argv) {
+    try {
+        generate(parse_options(argc, argv));
+    } catch (const std::exception& ex) {
+        fmt::print(os, "Error: {}\n\n", ex.what());
+        print_usage(os);
+        return -1;
+    }
+    return 0;
+}
+
+
+int main(int argc, const char** argv) {
+    return main_impl(std::cout, argc, argv);
+}